@@ -2,309 +2,4602 @@
 #define __SCC_INTERNIFY_HPP__
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cassert>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <mutex>
 #include <shared_mutex>
 #include <functional>
 #include <memory>
+#include <memory_resource>
+#include <iterator>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 
 namespace scc
 {
-    /**
-     * @brief The Internify class template provides a mechanism for interning objects of type T.
-     *
-     * Interning is a process where identical objects are stored only once in memory,
-     * and all references to these objects point to the same memory location.
-     * This can reduce memory usage and improve performance in cases where many identical objects are used.
-     *
-     * @tparam T The type of objects to be interned. T must be copyable.
-     * @tparam HashFunc A hash function object that takes an object of type T and returns a std::size_t. Defaults to std::hash<T>.
-     */
-    template <typename T, typename HashFunc = std::hash<T>>
-    class Internify
+    namespace detail
     {
-    public:
         /**
-         * @brief A smart pointer-like object that manages a reference to an interned object.
+         * @brief Size used to keep independently written data on separate cache lines.
+         */
+        inline constexpr std::size_t kCacheLineSize = 64;
+
+        /**
+         * @brief Process-wide epoch-based reclamation domain.
          *
-         * This class is responsible for managing the reference count of the interned object and
-         * ensures that the object is only deleted when there are no more references.
+         * Readers announce the global epoch they observed before touching shared memory and clear the
+         * announcement when they are done. Writers retire unlinked memory tagged with the epoch at the time of
+         * retirement; the global epoch only advances once every active reader has observed it, so memory
+         * retired in epoch e can be freed as soon as the global epoch reaches e + 2.
+         *
+         * Entering and leaving an epoch only touches a per-thread record on its own cache line, which lets
+         * read-mostly workloads scale with the number of cores.
          */
-        class InternedPtr
+        class EpochDomain
         {
+            struct Record;
+
         public:
             /**
-             * @brief Constructs an InternedPtr that points to an interned object managed by owner.
+             * @brief RAII guard that keeps the calling thread inside the current epoch.
              *
-             * @param owner Pointer to the owning Internify instance.
-             * @param ptr Pointer to the interned object.
+             * Guards nest; only the outermost guard announces and clears the epoch.
+             */
+            class Guard
+            {
+            public:
+                Guard() : m_record(EpochDomain::instance().enter()) {}
+                ~Guard() { EpochDomain::instance().leave(m_record); }
+
+                Guard(const Guard &) = delete;
+                Guard &operator=(const Guard &) = delete;
+
+                /**
+                 * @brief Returns true if the guard was created on the calling thread, whose epoch it holds.
+                 */
+                bool ownedByCallingThread() const { return m_record == threadRecord().record; }
+
+            private:
+                Record *m_record;
+            };
+
+            /**
+             * @brief Returns the domain shared by every intern pool in the process.
              */
-            InternedPtr(Internify *owner, const T *ptr)
-                : m_owner(owner), m_ptr(ptr) {}
+            static EpochDomain &instance()
+            {
+                static EpochDomain domain;
+                return domain;
+            }
 
             /**
-             * @brief Move constructor. Transfers ownership from other to the new InternedPtr.
+             * @brief Returns the epoch that memory unlinked now has to be tagged with.
              *
-             * @param other The other InternedPtr to move from.
+             * Must be called after the memory has been unlinked from every shared structure.
              */
-            InternedPtr(InternedPtr &&other) noexcept
-                : m_owner(other.m_owner), m_ptr(other.m_ptr)
+            std::uint64_t retireEpoch() const
             {
-                other.reset();
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                return m_epoch.load(std::memory_order_relaxed);
             }
 
             /**
-             * @brief Move assignment operator. Transfers ownership from other to the current InternedPtr.
+             * @brief Advances the global epoch if every active reader has observed the current one.
              *
-             * @param other The other InternedPtr to move from.
-             * @return InternedPtr& Reference to the current InternedPtr.
+             * @return std::uint64_t The global epoch after the attempt.
              */
-            InternedPtr &operator=(InternedPtr &&other) noexcept
+            std::uint64_t tryAdvance()
             {
-                if (this != &other)
+                std::uint64_t current = m_epoch.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                for (Record *record = m_head.load(std::memory_order_acquire); record; record = record->next)
                 {
-                    release();
-                    m_owner = other.m_owner;
-                    m_ptr = other.m_ptr;
-                    other.reset();
+                    const std::uint64_t local = record->local.load(std::memory_order_acquire);
+                    if (local != kQuiescent && local != current)
+                    {
+                        return current;
+                    }
                 }
-                return *this;
+                m_epoch.compare_exchange_strong(current, current + 1, std::memory_order_acq_rel);
+                return m_epoch.load(std::memory_order_relaxed);
             }
 
             /**
-             * @brief Destructor. Decrements the reference count of the interned object and deletes it if no more references exist.
+             * @brief Returns true if memory retired in epoch retired can no longer be reached by any reader.
              */
-            ~InternedPtr()
+            static bool isSafe(std::uint64_t retired, std::uint64_t current) { return retired + 2 <= current; }
+
+        private:
+            static constexpr std::uint64_t kQuiescent = 0;
+
+            struct alignas(kCacheLineSize) Record
             {
-                release();
+                std::atomic<std::uint64_t> local{kQuiescent};
+                std::atomic<bool> inUse{true};
+                unsigned depth = 0; // only touched by the owning thread
+                Record *next = nullptr;
+            };
+
+            /**
+             * @brief Gives the record back to the domain when its thread exits.
+             */
+            struct ThreadRecord
+            {
+                ~ThreadRecord()
+                {
+                    if (record)
+                    {
+                        record->inUse.store(false, std::memory_order_release);
+                    }
+                }
+
+                Record *record = nullptr;
+            };
+
+            EpochDomain() = default;
+
+            static ThreadRecord &threadRecord()
+            {
+                thread_local ThreadRecord thread;
+                return thread;
+            }
+
+            Record *enter()
+            {
+                ThreadRecord &thread = threadRecord();
+                if (!thread.record)
+                {
+                    thread.record = acquireRecord();
+                }
+                Record *record = thread.record;
+                if (record->depth++ == 0)
+                {
+                    // The release store also publishes everything this thread did in its previous epoch to the
+                    // writer that observes the new announcement in tryAdvance().
+                    record->local.store(m_epoch.load(std::memory_order_relaxed), std::memory_order_release);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                }
+                return record;
+            }
+
+            void leave(Record *record)
+            {
+                if (--record->depth == 0)
+                {
+                    record->local.store(kQuiescent, std::memory_order_release);
+                }
             }
 
             /**
-             * @brief Returns a pointer to the interned object.
-             *
-             * @return const T* Pointer to the interned object.
+             * @brief Reuses the record of an exited thread, or links a new one. Records are never freed.
              */
-            const T *get() const { return m_ptr; }
+            Record *acquireRecord()
+            {
+                for (Record *record = m_head.load(std::memory_order_acquire); record; record = record->next)
+                {
+                    bool expected = false;
+                    if (!record->inUse.load(std::memory_order_relaxed) &&
+                        record->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                    {
+                        return record;
+                    }
+                }
+                Record *record = new Record;
+                record->next = m_head.load(std::memory_order_relaxed);
+                while (!m_head.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed))
+                {
+                }
+                return record;
+            }
 
+            std::atomic<Record *> m_head{nullptr};
+            std::atomic<std::uint64_t> m_epoch{1};
+        };
+
+        /**
+         * @brief Process-wide buffers of deferred reference count changes, one per thread.
+         *
+         * In pools constructed with DeferredRefCounts, copying and dropping a handle adds +1 or -1 to an entry of
+         * the calling thread's buffer instead of writing the node's count, so the cache line of a popular node is
+         * not bounced between cores. An entry is written back to its count when it is evicted by another node,
+         * when its delta grows large, and when the pool reconciles. A count therefore only means something once
+         * every buffer has been written back: reconcile() does that with all buffers locked, which stops changes
+         * to any count while the pool decides which of its nodes are dead.
+         *
+         * Each buffer has its own lock, which only its thread takes outside of reconcile() and purge(), so it
+         * stays in that thread's cache.
+         */
+        class DeferredCounts
+        {
+        public:
             /**
-             * @brief Dereferences the pointer to access the interned object.
-             *
-             * @return const T& Reference to the interned object.
-             * @note it is undefined behavior if this instance is not valid.
+             * @brief The count of a node that reconcile() found dead; it can no longer be acquired.
              */
-            const T &operator*() const { return *m_ptr; }
+            static constexpr int kDead = std::numeric_limits<int>::min();
 
             /**
-             * @brief Returns a pointer to the interned object.
-             *
-             * @return const T* Pointer to the interned object.
+             * @brief Returns the domain shared by every intern pool in the process.
              */
-            const T *operator->() const { return m_ptr; }
+            static DeferredCounts &instance()
+            {
+                static DeferredCounts domain;
+                return domain;
+            }
 
             /**
-             * @brief Checks if the InternedPtr is valid (i.e., points to an interned object).
+             * @brief Records a change of delta to count, a reference count of a node of owner.
              *
-             * @return true If the InternedPtr is valid, false otherwise.
+             * The caller must hold a reference to the node, or be dropping one.
              */
-            operator bool() const { return m_ptr != nullptr && m_owner != nullptr; }
+            void add(const void *owner, std::atomic<int> *count, int delta)
+            {
+                Buffer &buffer = threadBuffer();
+                buffer.lock();
+                entryFor(buffer, owner, count).delta += delta;
+                buffer.unlock();
+            }
 
             /**
-             * @brief Returns true if the InternedPtr is valid, false otherwise.
+             * @brief Records a new reference to count unless reconcile() has declared its node dead.
              *
-             * @return true If the InternedPtr is valid, false otherwise.
+             * @return true If the reference was taken.
              */
-            bool is_valid() const { return m_ptr != nullptr && m_owner != nullptr; }
+            bool tryAcquire(const void *owner, std::atomic<int> *count)
+            {
+                Buffer &buffer = threadBuffer();
+                buffer.lock();
+                const bool alive = count->load(std::memory_order_relaxed) != kDead;
+                if (alive)
+                {
+                    entryFor(buffer, owner, count).delta += 1;
+                }
+                buffer.unlock();
+                return alive;
+            }
 
             /**
-             * @brief Compares two InternedPtr objects for equality.
+             * @brief Writes back every change recorded for owner, then calls markDead while no count can change.
              *
-             * @param other The other InternedPtr to compare with.
-             * @return true If both InternedPtr objects point to the same interned object.
-             * @return false If the InternedPtr objects point to different interned objects.
+             * markDead sees the exact reference counts of owner's nodes and sets the ones at zero to kDead.
              */
-            bool operator==(const InternedPtr &other) const { return m_ptr == other.m_ptr; }
+            template <typename MarkDead>
+            void reconcile(const void *owner, MarkDead &&markDead)
+            {
+                std::lock_guard registry(m_registry);
+                forEachBuffer([](Buffer &buffer)
+                              { buffer.lock(); });
+                forEachBuffer([owner](Buffer &buffer)
+                              { buffer.flush(owner); });
+                markDead();
+                forEachBuffer([](Buffer &buffer)
+                              { buffer.unlock(); });
+            }
 
             /**
-             * @brief Compares two InternedPtr objects for inequality.
+             * @brief Returns the sum of the changes recorded for owner and not yet written back.
              *
-             * @param other The other InternedPtr to compare with.
-             * @return true If the InternedPtr objects point to different interned objects.
-             * @return false If both InternedPtr objects point to the same interned object.
+             * Each buffer is read under its own lock, so the sum is a snapshot while other threads are recording.
+             */
+            std::int64_t pending(const void *owner)
+            {
+                std::lock_guard registry(m_registry);
+                std::int64_t total = 0;
+                forEachBuffer([owner, &total](Buffer &buffer)
+                              {
+                                  buffer.lock();
+                                  for (const Entry &entry : buffer.entries)
+                                  {
+                                      if (entry.count && entry.owner == owner)
+                                      {
+                                          total += entry.delta;
+                                      }
+                                  }
+                                  buffer.unlock(); });
+                return total;
+            }
+
+            /**
+             * @brief Drops every change recorded for owner, which is being destroyed.
              */
-            bool operator!=(const InternedPtr &other) const { return m_ptr != other.m_ptr; }
+            void purge(const void *owner)
+            {
+                std::lock_guard registry(m_registry);
+                forEachBuffer([owner](Buffer &buffer)
+                              {
+                                  buffer.lock();
+                                  for (Entry &entry : buffer.entries)
+                                  {
+                                      if (entry.owner == owner)
+                                      {
+                                          entry = {};
+                                      }
+                                  }
+                                  buffer.unlock(); });
+            }
+
+        private:
+            static constexpr std::size_t kBufferSize = 128;
+            static constexpr int kMaxDelta = 1 << 20; // written back early, far from overflowing the count
+
+            struct Entry
+            {
+                const void *owner = nullptr;
+                std::atomic<int> *count = nullptr; // nullptr marks a free entry
+                int delta = 0;
+
+                void writeBack()
+                {
+                    count->fetch_add(delta, std::memory_order_relaxed);
+                    *this = {};
+                }
+            };
+
+            struct alignas(kCacheLineSize) Buffer
+            {
+                void lock()
+                {
+                    while (locked.exchange(true, std::memory_order_acquire))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+
+                void unlock() { locked.store(false, std::memory_order_release); }
+
+                void flush(const void *owner)
+                {
+                    for (Entry &entry : entries)
+                    {
+                        if (entry.count && entry.owner == owner)
+                        {
+                            entry.writeBack();
+                        }
+                    }
+                }
 
-            // Disable copying
-            InternedPtr(const InternedPtr &) = delete;
-            InternedPtr &operator=(const InternedPtr &) = delete;
+                std::atomic<bool> locked{false};
+                std::atomic<bool> inUse{true};
+                Buffer *next = nullptr;
+                std::array<Entry, kBufferSize> entries{};
+            };
 
             /**
-             * @brief Releases the interned object, decrementing its reference count.
+             * @brief Gives the buffer back to the domain when its thread exits. Its pending changes stay in it.
              */
-            void release()
+            struct ThreadBuffer
             {
-                if (m_owner && m_ptr)
+                ~ThreadBuffer()
                 {
-                    m_owner->release(*m_ptr);
+                    if (buffer)
+                    {
+                        buffer->inUse.store(false, std::memory_order_release);
+                    }
                 }
 
-                reset();
+                Buffer *buffer = nullptr;
+            };
+
+            DeferredCounts() = default;
+
+            Buffer &threadBuffer()
+            {
+                thread_local ThreadBuffer thread;
+                if (!thread.buffer)
+                {
+                    thread.buffer = acquireBuffer();
+                }
+                return *thread.buffer;
             }
 
-        private:
             /**
-             * @brief Resets the InternedPtr to an invalid state.
+             * @brief Returns the entry of the buffer, which the caller has locked, that collects changes to count.
              */
-            void reset()
+            static Entry &entryFor(Buffer &buffer, const void *owner, std::atomic<int> *count)
             {
-                m_owner = nullptr;
-                m_ptr = nullptr;
+                const auto address = reinterpret_cast<std::uintptr_t>(count);
+                Entry &entry = buffer.entries[(address / alignof(std::max_align_t)) % kBufferSize];
+                if (entry.count != count || entry.delta >= kMaxDelta || entry.delta <= -kMaxDelta)
+                {
+                    if (entry.count)
+                    {
+                        entry.writeBack();
+                    }
+                    entry.owner = owner;
+                    entry.count = count;
+                }
+                return entry;
             }
 
-            Internify *m_owner = nullptr;
-            const T *m_ptr = nullptr;
+            /**
+             * @brief Reuses the buffer of an exited thread, or links a new one. Buffers are never freed.
+             */
+            Buffer *acquireBuffer()
+            {
+                std::lock_guard registry(m_registry);
+                for (Buffer *buffer = m_head; buffer; buffer = buffer->next)
+                {
+                    if (!buffer->inUse.load(std::memory_order_acquire))
+                    {
+                        buffer->inUse.store(true, std::memory_order_relaxed);
+                        return buffer;
+                    }
+                }
+                Buffer *buffer = new Buffer;
+                buffer->next = m_head;
+                m_head = buffer;
+                return buffer;
+            }
+
+            template <typename Fn>
+            void forEachBuffer(Fn &&fn)
+            {
+                for (Buffer *buffer = m_head; buffer; buffer = buffer->next)
+                {
+                    fn(*buffer);
+                }
+            }
+
+            std::mutex m_registry; // guards the buffer list; held by reconcile() so no buffer appears meanwhile
+            Buffer *m_head = nullptr;
         };
 
-        Internify() = default;
-        ~Internify() = default;
+        template <typename F, typename = void>
+        struct is_transparent : std::false_type
+        {
+        };
 
-        Internify(const Internify &) = delete;
-        Internify &operator=(const Internify &) = delete;
+        template <typename F>
+        struct is_transparent<F, std::void_t<typename F::is_transparent>> : std::true_type
+        {
+        };
 
         /**
-         * @brief Interns the given value. If the value is already interned, returns an InternedPtr pointing to the existing interned object.
-         *
-         * If the value is not already interned, inserts the value into the intern pool and returns an InternedPtr pointing to the newly interned object.
-         *
-         * @param value The value to be interned.
-         * @return InternedPtr A smart pointer to the interned object.
+         * @brief Enables the heterogeneous overloads of a pool of T for keys of type K other than T itself.
          */
-        [[nodiscard]] InternedPtr internify(const T &value)
+        template <typename HashFunc, typename KeyEqual, typename T, typename K>
+        using enable_if_heterogeneous_t = std::enable_if_t<is_transparent<HashFunc>::value &&
+                                                           is_transparent<KeyEqual>::value &&
+                                                           !std::is_same_v<std::decay_t<K>, T>>;
+
+        /**
+         * @brief Maps a string type to the string_view type over the same characters; void for other types.
+         */
+        template <typename T>
+        struct string_view_of
         {
-            const T *existing = findExisting(value);
-            if (existing)
-            {
-                return InternedPtr(this, existing);
-            }
-            return InternedPtr(this, insertNew(value));
-        }
+            using type = void;
+        };
+
+        template <typename CharT, typename Traits, typename Alloc>
+        struct string_view_of<std::basic_string<CharT, Traits, Alloc>>
+        {
+            using type = std::basic_string_view<CharT, Traits>;
+        };
 
         /**
-         * @brief Finds the interned object corresponding to value without creating a new entry.
-         *
-         * If the value is not found, returns an invalid InternedPtr.
-         *
-         * @param value The value to find in the intern pool.
-         * @return InternedPtr A smart pointer to the interned object, or an invalid InternedPtr if the object is not found.
+         * @brief True for Storage policies that place each value in the allocation of its node, see InlineStringStorage.
          */
-        [[nodiscard]] InternedPtr find(const T &value) const
+        template <typename Storage, typename = void>
+        struct has_inline_payload : std::false_type
         {
-            std::shared_lock lock(m_mutex);
-            auto it = m_interningMap.find(hashValue(value));
-            if (it != m_interningMap.end())
+        };
+
+        template <typename Storage>
+        struct has_inline_payload<Storage, std::void_t<decltype(Storage::inline_payload)>> : std::bool_constant<Storage::inline_payload>
+        {
+        };
+
+        /**
+         * @brief Returns the number of bits needed to represent value, i.e. one more than the index of its highest set bit.
+         */
+        inline constexpr unsigned bitWidth(std::uint64_t value)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return value == 0 ? 0 : 64 - static_cast<unsigned>(__builtin_clzll(value));
+#else
+            unsigned bits = 0;
+            for (; value != 0; value >>= 1)
             {
-                it->second->refCount.fetch_add(1, std::memory_order_relaxed);
-                return InternedPtr(const_cast<Internify *>(this), &(it->second->value));
+                ++bits;
             }
-            return InternedPtr(nullptr, nullptr);
+            return bits;
+#endif
         }
 
         /**
-         * @brief Returns the number of unique interned objects currently stored in the intern pool.
-         *
-         * @return std::size_t The number of interned objects.
+         * @brief Returns an id that no other pool of the process has had, so caches can tell pools apart.
          */
-        std::size_t size() const
+        inline std::uint64_t nextPoolId()
         {
-            std::shared_lock lock(m_mutex);
-            return m_interningMap.size();
+            static std::atomic<std::uint64_t> next{1};
+            return next.fetch_add(1, std::memory_order_relaxed);
         }
 
-    private:
-        struct InterningNode
+        /**
+         * @brief True for Storage policies that copy short keys into the table slots, see SmallKeySlots.
+         */
+        template <typename Storage, typename = void>
+        struct has_slot_keys : std::false_type
         {
-            explicit InterningNode(const T &val)
-                : value(val), refCount(1) {}
-
-            const T value;
-            std::atomic<int> refCount;
         };
 
-        using HashedValue = decltype(std::declval<HashFunc>()(std::declval<T>()));
+        template <typename Storage>
+        struct has_slot_keys<Storage, std::void_t<decltype(Storage::slot_key_bytes)>> : std::bool_constant<(Storage::slot_key_bytes > 0)>
+        {
+        };
 
         /**
-         * @brief Decrements the reference count of the interned object corresponding to value.
+         * @brief Returns how many characters a slot can hold inline so that it fills a power-of-two size.
          *
-         * If the reference count reaches zero, the object is removed from the intern pool.
+         * The slot is headerBytes of node pointer and hash plus a length and the characters, rounded up to a
+         * power of two, or to whole cache lines beyond one line; the characters take up the rounding.
          *
-         * @param value The value whose reference count should be decremented.
+         * @param minBytes The number of key bytes the slot must hold at least.
+         * @param headerBytes The size of the rest of the slot.
          */
-        void release(const T &value)
+        template <typename CharT>
+        constexpr std::size_t slotKeyChars(std::size_t minBytes, std::size_t headerBytes)
         {
-            std::unique_lock lock(m_mutex);
-            auto it = m_interningMap.find(hashValue(value));
-            if (it != m_interningMap.end() && it->second->refCount.fetch_sub(1, std::memory_order_relaxed) == 1)
-            {
-                m_interningMap.erase(it);
-            }
+            const std::size_t bytes = headerBytes + sizeof(CharT) + minBytes;
+            const std::size_t slot = bytes <= kCacheLineSize ? std::size_t{1} << bitWidth(bytes - 1)
+                                                             : (bytes + kCacheLineSize - 1) / kCacheLineSize * kCacheLineSize;
+            return (slot - headerBytes) / sizeof(CharT) - 1;
         }
 
         /**
-         * @brief Finds an existing interned object corresponding to value.
+         * @brief A copy of a short key in a table slot, so a probe can confirm or reject it without reading the node.
          *
-         * If found, increments the reference count.
+         * Keys longer than Chars are not copied; their slots are marked out of line and compared through the node.
          *
-         * @param value The value to find.
-         * @return const T* A pointer to the interned object, or nullptr if the object is not found.
+         * @tparam View The basic_string_view type of the keys.
+         * @tparam Chars The number of characters held inline; 0 disables the copy and makes the type empty.
          */
-        const T *findExisting(const T &value) const
+        template <typename View, std::size_t Chars>
+        struct SlotKey
         {
-            std::shared_lock lock(m_mutex);
-            auto it = m_interningMap.find(hashValue(value));
-            if (it != m_interningMap.end())
+            using CharT = typename View::value_type;
+            using Size = std::make_unsigned_t<CharT>;
+
+            static constexpr Size kOutOfLine = static_cast<Size>(~Size{0});
+            static_assert(Chars < kOutOfLine, "too many inline key characters for the character type");
+
+            enum class Match
             {
-                it->second->refCount.fetch_add(1, std::memory_order_relaxed);
-                return &(it->second->value);
-            }
-            return nullptr;
-        }
+                No,
+                Yes,
+                Unknown, // both keys are out of line; compare the node
+            };
 
-        /**
-         * @brief Inserts a new object into the intern pool and returns a pointer to the interned object.
-         *
-         * @param value The value to insert.
-         * @return const T* A pointer to the newly interned object.
-         */
-        const T *insertNew(const T &value)
-        {
-            std::unique_lock lock(m_mutex);
-            auto [it, inserted] = m_interningMap.try_emplace(hashValue(value),
-                                                             std::make_unique<InterningNode>(value));
-            if (inserted)
+            void setKey(View key) noexcept
             {
-                return &(it->second->value);
+                if (key.size() <= Chars)
+                {
+                    keySize = static_cast<Size>(key.size());
+                    View::traits_type::copy(keyChars, key.data(), key.size());
+                }
+                else
+                {
+                    keySize = kOutOfLine;
+                }
             }
-            else
+
+            Match matchKey(View key) const noexcept
             {
-                it->second->refCount.fetch_add(1, std::memory_order_relaxed);
-                return &(it->second->value);
+                if (keySize == kOutOfLine)
+                {
+                    return key.size() <= Chars ? Match::No : Match::Unknown;
+                }
+                return key.size() == keySize && View::traits_type::compare(keyChars, key.data(), keySize) == 0 ? Match::Yes : Match::No;
             }
-        }
+
+            Size keySize = 0;
+            CharT keyChars[Chars];
+        };
+
+        template <typename View>
+        struct SlotKey<View, 0>
+        {
+        };
 
         /**
-         * @brief Hashes the given value using the hash function provided in the template parameter.
+         * @brief Maps 32-bit symbol ids to the nodes they name.
          *
-         * @param value The value to hash.
-         * @return HashedValue The hashed value.
+         * Ids start at 1 and index a sequence of segments whose sizes double, so the index grows without ever
+         * moving an entry and resolving an id is two loads with no lock and no epoch. Ids of erased entries go
+         * to a free list and are handed out again. All writes happen under the owning pool's exclusive lock;
+         * readers only resolve ids they hold, which were published before they obtained them.
          */
-        HashedValue hashValue(const T &value) const
+        template <typename Node>
+        class SymbolIndex
         {
-            return HashFunc{}(value);
+        public:
+            SymbolIndex() = default;
+            SymbolIndex(const SymbolIndex &) = delete;
+            SymbolIndex &operator=(const SymbolIndex &) = delete;
+
+            /**
+             * @brief Hands out an id for node, reusing a released one if possible.
+             *
+             * @param node The node the new id names.
+             * @param maxId The largest id the caller can represent.
+             * @return std::uint32_t The new id.
+             */
+            std::uint32_t assign(Node *node, std::uint32_t maxId)
+            {
+                std::uint32_t id;
+                if (!m_free.empty())
+                {
+                    id = m_free.back();
+                    m_free.pop_back();
+                }
+                else
+                {
+                    if (m_next > maxId)
+                    {
+                        throw std::length_error("scc::Internify: symbol ids exhausted");
+                    }
+                    id = m_next++;
+                    auto &segment = m_segments[segmentOf(id)];
+                    if (!segment)
+                    {
+                        segment.reset(new Node *[std::size_t{1} << (segmentOf(id) + kFirstSegmentBits)]());
+                    }
+                }
+                entry(id) = node;
+                return id;
+            }
+
+            /**
+             * @brief Unbinds id from its node and queues it for reuse.
+             */
+            void free(std::uint32_t id)
+            {
+                entry(id) = nullptr;
+                m_free.push_back(id);
+            }
+
+            Node *operator[](std::uint32_t id) const { return entry(id); }
+
+        private:
+            static constexpr unsigned kFirstSegmentBits = 6; // the first segment holds 64 ids
+
+            /**
+             * @brief Position of id in the infinite sequence of segments, counted so that segment s starts at 2^(s + kFirstSegmentBits).
+             */
+            static std::uint64_t position(std::uint32_t id) { return std::uint64_t{id} - 1 + (std::uint64_t{1} << kFirstSegmentBits); }
+
+            static unsigned segmentOf(std::uint32_t id) { return bitWidth(position(id)) - 1 - kFirstSegmentBits; }
+
+            Node *&entry(std::uint32_t id) const
+            {
+                const unsigned segment = segmentOf(id);
+                return m_segments[segment][position(id) - (std::uint64_t{1} << (segment + kFirstSegmentBits))];
+            }
+
+            std::array<std::unique_ptr<Node *[]>, 33 - kFirstSegmentBits> m_segments; // enough for every 32-bit id
+            std::vector<std::uint32_t> m_free;
+            std::uint32_t m_next = 1;
+        };
+
+        /**
+         * @brief Allocates the nodes of one pool from slabs, recycling freed nodes through a free list.
+         *
+         * A value that is erased and interned again reuses the memory of its previous node, so steady churn does
+         * not reach the global allocator. Slabs start small and double up to kMaxSlabNodes nodes; they are only
+         * returned when the pool is destroyed. Not synchronized: the owning pool calls it under its exclusive lock.
+         */
+        template <typename Node>
+        class NodePool
+        {
+        public:
+            explicit NodePool(std::pmr::memory_resource *resource)
+                : m_resource(resource) {}
+
+            /**
+             * @brief Destructor. Returns every slab to the memory resource; the nodes must have been destroyed.
+             */
+            ~NodePool()
+            {
+                for (const Slab &slab : m_slabs)
+                {
+                    m_resource->deallocate(slab.blocks, slab.count * sizeof(Block), alignof(Block));
+                }
+            }
+
+            NodePool(const NodePool &) = delete;
+            NodePool &operator=(const NodePool &) = delete;
+
+            /**
+             * @brief Returns uninitialized memory for one Node.
+             */
+            void *allocate()
+            {
+                if (m_free)
+                {
+                    Block *block = m_free;
+                    m_free = block->next;
+                    return block;
+                }
+                if (m_next == m_end)
+                {
+                    const std::size_t count = m_slabs.empty() ? kMinSlabNodes : std::min(2 * m_slabs.back().count, kMaxSlabNodes);
+                    m_slabs.reserve(m_slabs.size() + 1);
+                    m_next = static_cast<Block *>(m_resource->allocate(count * sizeof(Block), alignof(Block)));
+                    m_end = m_next + count;
+                    m_slabs.push_back({m_next, count});
+                }
+                return m_next++;
+            }
+
+            /**
+             * @brief Puts memory returned by allocate(), whose Node has been destroyed, on the free list.
+             */
+            void deallocate(void *memory) noexcept
+            {
+                Block *block = ::new (memory) Block;
+                block->next = m_free;
+                m_free = block;
+            }
+
+            /**
+             * @brief Returns the slabs that hold no node to the memory resource.
+             *
+             * Nodes never move, so only slabs left entirely free can go. The pool does not track which nodes are in
+             * use; forEachLive(visit) has to call visit with every node that has not been deallocated.
+             *
+             * @param forEachLive A callable that takes a callable and calls it with the address of every live node.
+             */
+            template <typename ForEachLive>
+            void trim(ForEachLive &&forEachLive)
+            {
+                std::vector<std::size_t> byAddress(m_slabs.size());
+                for (std::size_t i = 0; i < byAddress.size(); ++i)
+                {
+                    byAddress[i] = i;
+                }
+                std::sort(byAddress.begin(), byAddress.end(), [this](std::size_t a, std::size_t b)
+                          { return std::less<const Block *>{}(m_slabs[a].blocks, m_slabs[b].blocks); });
+                auto slabOf = [this, &byAddress](const void *memory)
+                {
+                    const Block *block = static_cast<const Block *>(memory);
+                    auto it = std::upper_bound(byAddress.begin(), byAddress.end(), block, [this](const Block *b, std::size_t slab)
+                                               { return std::less<const Block *>{}(b, m_slabs[slab].blocks); });
+                    return *(it - 1);
+                };
+
+                std::vector<std::size_t> live(m_slabs.size(), 0);
+                forEachLive([&live, &slabOf](const void *node)
+                            { ++live[slabOf(node)]; });
+
+                Block **link = &m_free;
+                while (Block *block = *link)
+                {
+                    if (live[slabOf(block)] == 0)
+                    {
+                        *link = block->next;
+                    }
+                    else
+                    {
+                        link = &block->next;
+                    }
+                }
+                if (!m_slabs.empty() && live[m_slabs.size() - 1] == 0)
+                {
+                    m_next = m_end = nullptr;
+                }
+
+                std::size_t kept = 0;
+                for (std::size_t i = 0; i < m_slabs.size(); ++i)
+                {
+                    if (live[i] == 0)
+                    {
+                        m_resource->deallocate(m_slabs[i].blocks, m_slabs[i].count * sizeof(Block), alignof(Block));
+                    }
+                    else
+                    {
+                        m_slabs[kept++] = m_slabs[i];
+                    }
+                }
+                m_slabs.resize(kept);
+            }
+
+        private:
+            union Block
+            {
+                Block *next;
+                alignas(Node) unsigned char storage[sizeof(Node)];
+            };
+
+            struct Slab
+            {
+                Block *blocks;
+                std::size_t count;
+            };
+
+            static constexpr std::size_t kMinSlabNodes = 64;
+            static constexpr std::size_t kMaxSlabNodes = 4096;
+
+            std::pmr::memory_resource *const m_resource;
+            std::vector<Slab> m_slabs;
+            Block *m_free = nullptr; // freed nodes, most recently freed first
+            Block *m_next = nullptr; // the next never used node of the newest slab
+            Block *m_end = nullptr;
+        };
+
+        /**
+         * @brief A process-wide fork-join thread pool with work stealing, used by the intern_bulk() functions.
+         *
+         * run(count, fn) calls fn(i) for every i in [0, count) on the workers and the calling thread, and returns
+         * once all calls are done. The indices are dealt out round-robin to one deque per participant; each takes
+         * work from the back of its own deque and, once that is empty, steals from the front of the others, so a
+         * participant stuck on a large task does not hold up the rest. Tasks are meant to be coarse (thousands of
+         * keys each), which keeps the per-deque mutexes uncontended.
+         *
+         * The workers are started on first use, one fewer than the hardware threads, and joined at exit. Jobs from
+         * different threads run one at a time; fn must not call run() itself.
+         */
+        class TaskPool
+        {
+        public:
+            /**
+             * @brief Returns the pool shared by the whole process.
+             */
+            static TaskPool &instance()
+            {
+                static TaskPool pool;
+                return pool;
+            }
+
+            ~TaskPool()
+            {
+                {
+                    std::lock_guard lock(m_mutex);
+                    m_stopping = true;
+                }
+                m_wake.notify_all();
+                for (std::thread &worker : m_workers)
+                {
+                    worker.join();
+                }
+            }
+
+            TaskPool(const TaskPool &) = delete;
+            TaskPool &operator=(const TaskPool &) = delete;
+
+            /**
+             * @brief Returns the number of threads that work on a job, the caller included.
+             */
+            std::size_t concurrency() const { return m_workers.size() + 1; }
+
+            /**
+             * @brief Calls fn(i) for every i in [0, count) in parallel. Rethrows the first exception fn threw.
+             */
+            template <typename Fn>
+            void run(std::size_t count, Fn &&fn)
+            {
+                std::lock_guard serial(m_jobMutex);
+                Job job(concurrency(), count, [&fn](std::size_t i)
+                        { fn(i); });
+                {
+                    std::lock_guard lock(m_mutex);
+                    m_job = &job;
+                    ++m_generation;
+                }
+                m_wake.notify_all();
+                job.work(0);
+                {
+                    std::unique_lock lock(m_mutex);
+                    m_done.wait(lock, [this]
+                                { return m_busy == 0; });
+                    m_job = nullptr;
+                }
+                if (job.error)
+                {
+                    std::rethrow_exception(job.error);
+                }
+            }
+
+        private:
+            struct Job
+            {
+                struct Queue
+                {
+                    std::mutex mutex;
+                    std::deque<std::size_t> tasks;
+                };
+
+                Job(std::size_t participants, std::size_t count, std::function<void(std::size_t)> task)
+                    : queues(participants), fn(std::move(task))
+                {
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        queues[i % participants].tasks.push_back(count - 1 - i);
+                    }
+                }
+
+                /**
+                 * @brief Runs tasks as participant self until no deque has any left.
+                 */
+                void work(std::size_t self)
+                {
+                    std::size_t task;
+                    while (popOwn(self, task) || steal(self, task))
+                    {
+                        if (!failed.load(std::memory_order_relaxed))
+                        {
+                            try
+                            {
+                                fn(task);
+                            }
+                            catch (...)
+                            {
+                                std::lock_guard lock(errorMutex);
+                                if (!error)
+                                {
+                                    error = std::current_exception();
+                                }
+                                failed.store(true, std::memory_order_relaxed);
+                            }
+                        }
+                    }
+                }
+
+                bool popOwn(std::size_t self, std::size_t &task)
+                {
+                    Queue &queue = queues[self];
+                    std::lock_guard lock(queue.mutex);
+                    if (queue.tasks.empty())
+                    {
+                        return false;
+                    }
+                    task = queue.tasks.back();
+                    queue.tasks.pop_back();
+                    return true;
+                }
+
+                bool steal(std::size_t self, std::size_t &task)
+                {
+                    for (std::size_t i = 1; i < queues.size(); ++i)
+                    {
+                        Queue &victim = queues[(self + i) % queues.size()];
+                        std::lock_guard lock(victim.mutex);
+                        if (!victim.tasks.empty())
+                        {
+                            task = victim.tasks.front();
+                            victim.tasks.pop_front();
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                std::vector<Queue> queues;
+                std::function<void(std::size_t)> fn;
+                std::atomic<bool> failed{false};
+                std::mutex errorMutex;
+                std::exception_ptr error;
+            };
+
+            TaskPool()
+            {
+                const unsigned hardware = std::thread::hardware_concurrency();
+                for (unsigned i = 1; i < hardware; ++i)
+                {
+                    m_workers.emplace_back([this, i]
+                                           { workerLoop(i); });
+                }
+            }
+
+            void workerLoop(std::size_t self)
+            {
+                std::uint64_t seen = 0;
+                for (;;)
+                {
+                    Job *job;
+                    {
+                        std::unique_lock lock(m_mutex);
+                        m_wake.wait(lock, [this, seen]
+                                    { return m_stopping || (m_job && m_generation != seen); });
+                        if (m_stopping)
+                        {
+                            return;
+                        }
+                        seen = m_generation;
+                        job = m_job;
+                        ++m_busy;
+                    }
+                    job->work(self);
+                    {
+                        std::lock_guard lock(m_mutex);
+                        --m_busy;
+                    }
+                    m_done.notify_one();
+                }
+            }
+
+            std::vector<std::thread> m_workers;
+            std::mutex m_jobMutex; // one job at a time
+            std::mutex m_mutex;    // guards the fields below
+            std::condition_variable m_wake;
+            std::condition_variable m_done;
+            Job *m_job = nullptr;
+            std::uint64_t m_generation = 0;
+            std::size_t m_busy = 0; // workers inside the current job
+            bool m_stopping = false;
+        };
+
+        inline constexpr std::size_t kBulkChunkSize = 4096; // values per intern_bulk() task
+
+        /**
+         * @brief Calls fn(begin, end) for consecutive chunks of kBulkChunkSize indices covering [0, count).
+         *
+         * A single chunk runs on the calling thread; more are spread over the TaskPool.
+         */
+        template <typename Fn>
+        void forEachChunk(std::size_t count, Fn &&fn)
+        {
+            const std::size_t chunks = (count + kBulkChunkSize - 1) / kBulkChunkSize;
+            if (chunks <= 1)
+            {
+                fn(std::size_t{0}, count);
+                return;
+            }
+            TaskPool::instance().run(chunks, [&fn, count](std::size_t chunk)
+                                     { fn(chunk * kBulkChunkSize, std::min(count, (chunk + 1) * kBulkChunkSize)); });
+        }
+
+        /**
+         * @brief Forwards to an upstream resource and keeps track of the bytes currently allocated through it.
+         */
+        class CountingResource : public std::pmr::memory_resource
+        {
+        public:
+            explicit CountingResource(std::pmr::memory_resource *upstream)
+                : m_upstream(upstream) {}
+
+            std::size_t allocated_bytes() const { return m_bytes.load(std::memory_order_relaxed); }
+
+        private:
+            void *do_allocate(std::size_t bytes, std::size_t alignment) override
+            {
+                void *memory = m_upstream->allocate(bytes, alignment);
+                m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+                return memory;
+            }
+
+            void do_deallocate(void *memory, std::size_t bytes, std::size_t alignment) override
+            {
+                m_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+                m_upstream->deallocate(memory, bytes, alignment);
+            }
+
+            bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+            {
+                return this == &other;
+            }
+
+            std::pmr::memory_resource *const m_upstream;
+            std::atomic<std::size_t> m_bytes{0};
+        };
+
+        /**
+         * @brief Where the bytes of one interned value are, as far as memory_stats() is concerned.
+         */
+        struct ValueFootprint
+        {
+            std::size_t content = 0;  // the value's data: the characters of a string, the object itself otherwise
+            std::size_t inNode = 0;   // the part of content stored inside the node, e.g. a short string
+            std::size_t external = 0; // bytes the value allocated on its own, outside the pool's memory resource
+        };
+
+        template <typename T>
+        ValueFootprint footprintOf(const T &)
+        {
+            return {sizeof(T), sizeof(T), 0};
+        }
+
+        template <typename CharT, typename Traits, typename Alloc>
+        ValueFootprint footprintOf(const std::basic_string<CharT, Traits, Alloc> &value)
+        {
+            const std::size_t content = value.size() * sizeof(CharT);
+            const auto *data = reinterpret_cast<const char *>(value.data());
+            const auto *object = reinterpret_cast<const char *>(&value);
+            if (data >= object && data < object + sizeof(value))
+            {
+                return {content, content, 0}; // small string buffer
+            }
+            return {content, 0, (value.capacity() + 1) * sizeof(CharT)};
+        }
+
+        template <typename CharT, typename Traits>
+        ValueFootprint footprintOf(const std::basic_string_view<CharT, Traits> &value)
+        {
+            // The characters belong to the Storage, whose memory comes from the pool's resource.
+            return {value.size() * sizeof(CharT), 0, 0};
+        }
+    }
+
+    /**
+     * @brief Selects deferred reference counting when passed to the constructor of Internify or ShardedInternify.
+     */
+    struct DeferredRefCounts
+    {
+        explicit DeferredRefCounts() = default;
+    };
+
+    inline constexpr DeferredRefCounts deferred_refcounts{};
+
+    /**
+     * @brief Keeps every interned object that is reachable while it exists from being freed, see Internify::borrow().
+     *
+     * A guard announces the calling thread as a reader to the epoch-based reclamation shared by all pools. It costs
+     * one store on a thread-local cache line when created and one when destroyed, and guards nest. While any guard
+     * lives, no pool frees memory erased after the guard was created, so guards should be short-lived.
+     *
+     * A guard only protects the thread that created it: it must be created, used and destroyed on one thread.
+     */
+    class ReadGuard
+    {
+    public:
+        ReadGuard() = default;
+
+        ReadGuard(const ReadGuard &) = delete;
+        ReadGuard &operator=(const ReadGuard &) = delete;
+
+    private:
+        template <typename, typename, typename, typename>
+        friend class Internify;
+
+        detail::EpochDomain::Guard m_guard;
+    };
+
+    /**
+     * @brief A compact handle to an interned object: a 32-bit id that is unique within its pool while the object is interned.
+     *
+     * Ids are plain integers, so they can be stored densely, sorted and compared without touching the pool. Each id
+     * returned by internify_id() or to_id() owns one reference; the pool reuses an id once its object is released.
+     */
+    using SymbolId = std::uint32_t;
+
+    /**
+     * @brief The SymbolId that names nothing.
+     */
+    inline constexpr SymbolId kNoSymbol = 0;
+
+    template <typename T, typename HashFunc, typename KeyEqual, std::size_t ShardCount, typename Storage>
+    class ShardedInternify;
+
+    template <typename T, typename HashFunc, typename KeyEqual, typename Storage>
+    class ImmortalInternify;
+
+    namespace detail
+    {
+        struct ImmortalTag
+        {
+        };
+    }
+
+    /**
+     * @brief The default hash function of the intern pools.
+     *
+     * Behaves like std::hash<T>. For std::basic_string it is transparent: anything convertible to the matching
+     * std::basic_string_view can be hashed without building a string first, and the result is the same as
+     * std::hash<std::basic_string<...>> would produce.
+     *
+     * @tparam T The type to hash.
+     */
+    template <typename T>
+    struct Hash : std::hash<T>
+    {
+    };
+
+    template <typename CharT, typename Traits, typename Alloc>
+    struct Hash<std::basic_string<CharT, Traits, Alloc>>
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(std::basic_string_view<CharT, Traits> value) const noexcept
+        {
+            return std::hash<std::basic_string_view<CharT, Traits>>{}(value);
+        }
+    };
+
+    /**
+     * @brief A snapshot of what an intern pool costs, as returned by memory_stats().
+     *
+     * The byte counts cover the memory the pool allocates itself, plus the buffers of values such as std::string
+     * that allocate on their own. Small bookkeeping structures (the retire list, the symbol id index) are not
+     * included. The byte figures are kept up to date on insert and erase; total_references is summed when the
+     * snapshot is taken.
+     */
+    struct MemoryStats
+    {
+        std::size_t live_entries = 0;     // unique values currently interned
+        std::size_t zombie_entries = 0;   // released entries kept for reuse, counted in the byte figures, see set_zombie_budget()
+        std::size_t total_references = 0; // references held by handles and ids, summed over all entries
+        double dedup_ratio = 0;           // total_references / live_entries: how many copies one entry stands in for
+        std::size_t value_bytes = 0;      // the values' data, e.g. the characters of strings
+        std::size_t node_bytes = 0;       // per-entry overhead: reference count, cached hash, id and value object, minus data stored inline
+        std::size_t table_bytes = 0;      // slot tables, including replaced ones not reclaimed yet
+        std::size_t slack_bytes = 0;      // allocated but holding no live data: free slab slots, unused chunk space, string capacity, erased nodes awaiting reclamation
+
+        /**
+         * @brief Returns the total number of bytes the pool holds.
+         *
+         * @return std::size_t value_bytes + node_bytes + table_bytes + slack_bytes.
+         */
+        std::size_t total_bytes() const { return value_bytes + node_bytes + table_bytes + slack_bytes; }
+
+        /**
+         * @brief Adds the figures of other, e.g. of another shard.
+         */
+        MemoryStats &operator+=(const MemoryStats &other)
+        {
+            live_entries += other.live_entries;
+            zombie_entries += other.zombie_entries;
+            total_references += other.total_references;
+            value_bytes += other.value_bytes;
+            node_bytes += other.node_bytes;
+            table_bytes += other.table_bytes;
+            slack_bytes += other.slack_bytes;
+            dedup_ratio = live_entries ? static_cast<double>(total_references) / static_cast<double>(live_entries) : 0;
+            return *this;
+        }
+    };
+
+    /**
+     * @brief Counters of the calling thread's front cache, see Internify::internify_cached().
+     */
+    struct FrontCacheStats
+    {
+        std::uint64_t hits = 0;   // lookups answered by the cache
+        std::uint64_t misses = 0; // lookups that went to the pool
+
+        /**
+         * @brief Returns hits / (hits + misses), or 0 before the first lookup.
+         */
+        double hit_rate() const
+        {
+            const std::uint64_t lookups = hits + misses;
+            return lookups ? static_cast<double>(hits) / static_cast<double>(lookups) : 0;
+        }
+    };
+
+    /**
+     * @brief A memory resource that backs pools with 2 MiB transparent huge pages, for tables too big for the TLB.
+     *
+     * With tens of millions of entries, every probe of the slot table and every node it leads to sits on a
+     * different 4 KiB page, and TLB misses dominate the lookup. Passing this resource to a pool's constructor
+     * places its slot tables, node slabs and storage chunks in anonymous mappings advised with MADV_HUGEPAGE:
+     *  - allocations of at least kDedicatedSize bytes, such as large tables, get a mapping of their own, rounded
+     *    to whole huge pages and unmapped as soon as they are freed;
+     *  - smaller ones are bump-allocated from shared 2 MiB regions. A region whose allocations have all been freed,
+     *    e.g. by Internify::compact(), gets MADV_DONTNEED so its pages go back to the system, and is reused later.
+     * Space freed inside a region that still holds other allocations is not reused, so the resource suits the
+     * pool's large, long-lived blocks. Values that allocate per entry, such as std::pmr::string, are better
+     * served by a std::pmr::unsynchronized_pool_resource layered on top.
+     *
+     * Whether the kernel actually provides huge pages depends on its transparent huge page setting ("madvise" or
+     * "always"). On platforms other than Linux, every call is forwarded to the upstream resource. The resource is
+     * thread-safe and may be shared by several pools; it must outlive them.
+     */
+    class HugePageResource : public std::pmr::memory_resource
+    {
+    public:
+        static constexpr std::size_t kHugePageSize = std::size_t{2} << 20;
+        static constexpr std::size_t kDedicatedSize = kHugePageSize / 4;
+
+        /**
+         * @brief Constructs the resource.
+         *
+         * @param upstream The resource used where huge pages are not available.
+         */
+        explicit HugePageResource(std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+            : m_upstream(upstream)
+        {
+        }
+
+        HugePageResource(const HugePageResource &) = delete;
+        HugePageResource &operator=(const HugePageResource &) = delete;
+
+        /**
+         * @brief Unmaps the shared regions. Dedicated mappings must have been deallocated by their owners.
+         */
+        ~HugePageResource() override
+        {
+#if defined(__linux__)
+            for (Region *region : m_regions)
+            {
+                ::munmap(region, kHugePageSize);
+            }
+#endif
+        }
+
+        /**
+         * @brief Returns the number of bytes currently mapped, including regions that have been handed back.
+         */
+        std::size_t mapped_bytes() const
+        {
+            std::lock_guard lock(m_mutex);
+            return m_mapped;
+        }
+
+    private:
+        /**
+         * @brief The header at the start of every shared region. Zero after MADV_DONTNEED, which means empty.
+         */
+        struct Region
+        {
+            std::size_t used; // bytes handed out, header included; 0 after MADV_DONTNEED
+            std::size_t live; // allocations not yet freed
+        };
+
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+#if defined(__linux__)
+            if (bytes >= kDedicatedSize || alignment > kHugePageSize / 2)
+            {
+                std::lock_guard lock(m_mutex);
+                return mapAligned(roundUp(bytes, kHugePageSize), std::max(alignment, kHugePageSize));
+            }
+
+            std::lock_guard lock(m_mutex);
+            std::size_t offset = m_current ? roundUp(std::max(m_current->used, sizeof(Region)), alignment) : kHugePageSize;
+            if (offset + bytes > kHugePageSize)
+            {
+                m_current = takeRegion();
+                offset = roundUp(sizeof(Region), alignment);
+            }
+            m_current->used = offset + bytes;
+            ++m_current->live;
+            return reinterpret_cast<char *>(m_current) + offset;
+#else
+            return m_upstream->allocate(bytes, alignment);
+#endif
+        }
+
+        void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+        {
+#if defined(__linux__)
+            if (bytes >= kDedicatedSize || alignment > kHugePageSize / 2)
+            {
+                std::lock_guard lock(m_mutex);
+                const std::size_t size = roundUp(bytes, kHugePageSize);
+                ::munmap(p, size);
+                m_mapped -= size;
+                return;
+            }
+
+            std::lock_guard lock(m_mutex);
+            Region *region = reinterpret_cast<Region *>(reinterpret_cast<std::uintptr_t>(p) & ~(kHugePageSize - 1));
+            if (--region->live == 0)
+            {
+                // Also zeroes the header, which marks the region as empty without touching its pages again.
+                ::madvise(region, kHugePageSize, MADV_DONTNEED);
+            }
+#else
+            m_upstream->deallocate(p, bytes, alignment);
+#endif
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+
+#if defined(__linux__)
+        static std::size_t roundUp(std::size_t value, std::size_t alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        /**
+         * @brief Returns an empty shared region, reusing one that was handed back before mapping a new one.
+         */
+        Region *takeRegion()
+        {
+            for (Region *region : m_regions)
+            {
+                if (region->live == 0 && region != m_current)
+                {
+                    return region;
+                }
+            }
+            m_regions.reserve(m_regions.size() + 1);
+            Region *region = static_cast<Region *>(mapAligned(kHugePageSize, kHugePageSize));
+            m_regions.push_back(region); // fresh anonymous memory reads as zero, i.e. empty
+            return region;
+        }
+
+        /**
+         * @brief Maps size bytes aligned to alignment and advises them for huge pages. The caller holds m_mutex.
+         */
+        void *mapAligned(std::size_t size, std::size_t alignment)
+        {
+            // Over-map by the alignment, then unmap the parts before and after the aligned block.
+            const std::size_t mapped = size + alignment;
+            void *memory = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED)
+            {
+                throw std::bad_alloc();
+            }
+            char *begin = static_cast<char *>(memory);
+            char *aligned = reinterpret_cast<char *>(roundUp(reinterpret_cast<std::uintptr_t>(begin), alignment));
+            if (aligned != begin)
+            {
+                ::munmap(begin, static_cast<std::size_t>(aligned - begin));
+            }
+            if (char *end = aligned + size; end != begin + mapped)
+            {
+                ::munmap(end, static_cast<std::size_t>(begin + mapped - end));
+            }
+            ::madvise(aligned, size, MADV_HUGEPAGE);
+            m_mapped += size;
+            return aligned;
+        }
+#endif
+
+        [[maybe_unused]] std::pmr::memory_resource *const m_upstream;
+        mutable std::mutex m_mutex;
+        std::vector<Region *> m_regions; // every shared region ever mapped
+        Region *m_current = nullptr;     // the region small allocations are carved from
+        std::size_t m_mapped = 0;
+    };
+
+    /**
+     * @brief The default storage policy of the intern pools: every value lives inside its own node.
+     *
+     * A storage policy decides how the interned values are held. It provides value_type, the type the pool hands
+     * out, and two hooks that the pool only calls while holding its exclusive lock:
+     *  - store(key) returns what the value_type of a new entry is constructed from;
+     *  - discard(value) is called once an erased entry can no longer be reached by any reader.
+     * compact() returns memory that the storage keeps for future entries to the system.
+     *
+     * A policy that sets inline_payload instead provides payload_size(key), store(key, payload) and node_resource():
+     * the pool then allocates every node with payload_size(key) extra bytes from node_resource(), and store()
+     * writes the value's data there.
+     *
+     * @tparam T The type of objects to be interned.
+     */
+    template <typename T>
+    struct ValueStorage
+    {
+        using value_type = T;
+
+        template <typename K>
+        K &&store(K &&key) { return std::forward<K>(key); }
+
+        void discard(const value_type &) noexcept {}
+
+        void compact() noexcept {}
+    };
+
+    /**
+     * @brief A storage policy for string pools that packs the characters of all interned strings into large chunks.
+     *
+     * Characters are bump-allocated into chunks of ChunkSize bytes and the pool hands out views into them, so
+     * strings interned together sit next to each other, there is no allocator header per string, and walking the
+     * pool touches few cache lines. A string longer than a chunk gets a chunk of its own.
+     *
+     * The views stay valid as long as their entry is interned, so strings are never moved. Instead, each chunk
+     * counts its live strings: a chunk whose strings were all discarded is kept for reuse, and compact() frees
+     * such chunks.
+     *
+     * Use it as the Storage argument of Internify<std::basic_string<CharT, Traits>>, whose KeyEqual must then
+     * compare the views with the keys, as the default std::equal_to<> does.
+     *
+     * @tparam CharT The character type.
+     * @tparam Traits The character traits.
+     * @tparam ChunkSize The size in bytes of a regular chunk. Must be a power of two.
+     */
+    template <typename CharT = char, typename Traits = std::char_traits<CharT>, std::size_t ChunkSize = 64 * 1024>
+    class ArenaStringStorage
+    {
+        static_assert((ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+    public:
+        using value_type = std::basic_string_view<CharT, Traits>;
+
+        /**
+         * @brief Constructs an empty arena whose chunks are allocated from resource.
+         *
+         * @param resource The memory resource for the chunks. Defaults to std::pmr::get_default_resource().
+         */
+        explicit ArenaStringStorage(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : m_resource(resource) {}
+
+        /**
+         * @brief Destructor. Frees every chunk, including those still holding strings.
+         */
+        ~ArenaStringStorage()
+        {
+            freeList(m_chunks);
+            freeList(m_spare);
+        }
+
+        ArenaStringStorage(const ArenaStringStorage &) = delete;
+        ArenaStringStorage &operator=(const ArenaStringStorage &) = delete;
+
+        /**
+         * @brief Copies the characters of key into the current chunk, starting a new one if they do not fit.
+         *
+         * @param key Anything convertible to value_type.
+         * @return value_type A view of the stored copy.
+         */
+        template <typename K>
+        value_type store(const K &key)
+        {
+            const value_type view(key);
+            if (view.empty())
+            {
+                return value_type();
+            }
+
+            const std::size_t bytes = view.size() * sizeof(CharT);
+            Chunk *chunk = m_chunks;
+            // Only regular chunks are filled: a small string placed beyond the first ChunkSize bytes of a large
+            // chunk would make chunkOf() find a header inside other strings.
+            if (!chunk || chunk->capacity != kRegularCapacity || chunk->capacity - chunk->used < bytes)
+            {
+                if (chunk && chunk->live == 0)
+                {
+                    // An empty regular chunk is only left behind for a large string; release() keeps it as a spare.
+                    unlink(chunk);
+                    release(chunk);
+                }
+                chunk = bytes > kRegularCapacity ? newChunk(kHeaderSize + bytes) : takeSpare();
+                link(chunk);
+            }
+            CharT *data = reinterpret_cast<CharT *>(reinterpret_cast<char *>(chunk) + kHeaderSize + chunk->used);
+            Traits::copy(data, view.data(), view.size());
+            chunk->used += bytes;
+            ++chunk->live;
+            return value_type(data, view.size());
+        }
+
+        /**
+         * @brief Drops a string returned by store(). A regular chunk left without strings is kept for reuse, a large one is freed.
+         *
+         * @param value The view returned by store().
+         */
+        void discard(const value_type &value) noexcept
+        {
+            if (value.empty())
+            {
+                return;
+            }
+
+            Chunk *chunk = chunkOf(value.data());
+            if (--chunk->live != 0)
+            {
+                return;
+            }
+            if (chunk == m_chunks && chunk->capacity == kRegularCapacity)
+            {
+                chunk->used = 0; // the current chunk is simply refilled from its start
+                return;
+            }
+
+            unlink(chunk);
+            release(chunk);
+        }
+
+        /**
+         * @brief Frees the chunks that hold no strings, including the current one if it is empty.
+         */
+        void compact() noexcept
+        {
+            freeList(m_spare);
+            m_spare = nullptr;
+            if (m_chunks && m_chunks->live == 0)
+            {
+                Chunk *chunk = m_chunks;
+                unlink(chunk);
+                freeChunk(chunk);
+            }
+        }
+
+        /**
+         * @brief Returns the number of chunks currently allocated, spare ones included.
+         *
+         * @return std::size_t The number of chunks.
+         */
+        std::size_t chunk_count() const noexcept
+        {
+            std::size_t count = 0;
+            for (const Chunk *chunk = m_chunks; chunk; chunk = chunk->next)
+            {
+                ++count;
+            }
+            for (const Chunk *chunk = m_spare; chunk; chunk = chunk->next)
+            {
+                ++count;
+            }
+            return count;
+        }
+
+    private:
+        /**
+         * @brief Header at the start of every chunk, ChunkSize-aligned so that chunkOf() finds it from any string in it.
+         */
+        struct Chunk
+        {
+            Chunk *prev;
+            Chunk *next;
+            std::size_t capacity; // bytes available after the header
+            std::size_t used;     // bytes handed out so far
+            std::size_t live;     // strings stored and not yet discarded
+        };
+
+        static constexpr std::size_t kHeaderSize = (sizeof(Chunk) + alignof(CharT) - 1) / alignof(CharT) * alignof(CharT);
+        static constexpr std::size_t kRegularCapacity = ChunkSize - kHeaderSize;
+        static_assert(ChunkSize > kHeaderSize, "ChunkSize is too small");
+
+        static Chunk *chunkOf(const CharT *data)
+        {
+            return reinterpret_cast<Chunk *>(reinterpret_cast<std::uintptr_t>(data) & ~std::uintptr_t{ChunkSize - 1});
+        }
+
+        Chunk *newChunk(std::size_t size)
+        {
+            void *memory = m_resource->allocate(size, ChunkSize);
+            return new (memory) Chunk{nullptr, nullptr, size - kHeaderSize, 0, 0};
+        }
+
+        void freeChunk(Chunk *chunk) noexcept
+        {
+            m_resource->deallocate(chunk, kHeaderSize + chunk->capacity, ChunkSize);
+        }
+
+        void freeList(Chunk *chunk) noexcept
+        {
+            while (chunk)
+            {
+                Chunk *next = chunk->next;
+                freeChunk(chunk);
+                chunk = next;
+            }
+        }
+
+        /**
+         * @brief Keeps an unlinked empty chunk for reuse if it is a regular one, and frees it otherwise.
+         */
+        void release(Chunk *chunk) noexcept
+        {
+            if (chunk->capacity == kRegularCapacity)
+            {
+                chunk->used = 0;
+                chunk->next = m_spare;
+                m_spare = chunk;
+            }
+            else
+            {
+                freeChunk(chunk);
+            }
+        }
+
+        Chunk *takeSpare()
+        {
+            if (!m_spare)
+            {
+                return newChunk(ChunkSize);
+            }
+            Chunk *chunk = m_spare;
+            m_spare = chunk->next;
+            return chunk;
+        }
+
+        /**
+         * @brief Makes chunk the current one by putting it at the head of the list of chunks in use.
+         */
+        void link(Chunk *chunk) noexcept
+        {
+            chunk->prev = nullptr;
+            chunk->next = m_chunks;
+            if (m_chunks)
+            {
+                m_chunks->prev = chunk;
+            }
+            m_chunks = chunk;
+        }
+
+        void unlink(Chunk *chunk) noexcept
+        {
+            (chunk->prev ? chunk->prev->next : m_chunks) = chunk->next;
+            if (chunk->next)
+            {
+                chunk->next->prev = chunk->prev;
+            }
+        }
+
+        std::pmr::memory_resource *const m_resource;
+        Chunk *m_chunks = nullptr; // chunks holding strings; the head is the one being filled
+        Chunk *m_spare = nullptr;  // empty regular chunks kept for reuse
+    };
+
+    /**
+     * @brief A storage policy for string pools that puts the characters of each string into its node.
+     *
+     * The reference count, the cached hash, the length and the characters share a single variable-length
+     * allocation and the pool hands out views of the characters, so an entry costs one allocation instead of a
+     * node plus a string buffer, and the count and the first bytes sit on the same cache line. The characters
+     * are followed by a null character, so data() can be passed to C APIs.
+     *
+     * Use it as the Storage argument of Internify<std::basic_string<CharT, Traits>>, whose KeyEqual must then
+     * compare the views with the keys, as the default std::equal_to<> does. The nodes vary in size, so instead
+     * of the pool's slabs they come from a std::pmr::unsynchronized_pool_resource, which recycles freed nodes by
+     * size class. It draws its memory from the pool's resource and keeps it until the pool is destroyed.
+     *
+     * @tparam CharT The character type.
+     * @tparam Traits The character traits.
+     */
+    template <typename CharT = char, typename Traits = std::char_traits<CharT>>
+    class InlineStringStorage
+    {
+    public:
+        using value_type = std::basic_string_view<CharT, Traits>;
+
+        static constexpr bool inline_payload = true;
+
+        /**
+         * @brief Constructs the storage; its nodes are carved from memory obtained from resource.
+         *
+         * @param resource The upstream memory resource. Defaults to std::pmr::get_default_resource().
+         */
+        explicit InlineStringStorage(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : m_nodes(resource) {}
+
+        /**
+         * @brief Returns the resource the pool allocates nodes, including their payload, from.
+         *
+         * @return std::pmr::memory_resource* The node resource.
+         */
+        std::pmr::memory_resource *node_resource() { return &m_nodes; }
+
+        /**
+         * @brief Returns the number of bytes the node of key needs after its header.
+         *
+         * @param key Anything convertible to value_type.
+         * @return std::size_t The payload size in bytes.
+         */
+        template <typename K>
+        static std::size_t payload_size(const K &key)
+        {
+            return (value_type(key).size() + 1) * sizeof(CharT);
+        }
+
+        /**
+         * @brief Copies the characters of key and a terminating null character to payload.
+         *
+         * @param key Anything convertible to value_type.
+         * @param payload payload_size(key) bytes right after the node header.
+         * @return value_type A view of the stored copy.
+         */
+        template <typename K>
+        static value_type store(const K &key, void *payload)
+        {
+            const value_type view(key);
+            CharT *data = static_cast<CharT *>(payload);
+            Traits::copy(data, view.data(), view.size());
+            Traits::assign(data[view.size()], CharT());
+            return value_type(data, view.size());
+        }
+
+        static void discard(const value_type &) noexcept {}
+
+        static void compact() noexcept {}
+
+    private:
+        std::pmr::unsynchronized_pool_resource m_nodes;
+    };
+
+    /**
+     * @brief A storage policy adapter for string pools that also copies short keys into the table slots.
+     *
+     * Each slot then carries the length and characters of a key of up to KeyBytes bytes next to its hash, and is
+     * padded to a power of two, or to whole cache lines, with the padding holding further characters. A probe
+     * confirms or rejects a short key within the slot, so mismatches never touch a node, and a hit only touches
+     * the node to take its reference; ImmortalInternify hits, which take none, read nothing but the slot. Longer
+     * keys are compared through their nodes as usual, and values are stored by Base.
+     *
+     * Matching compares characters, so KeyEqual must be plain equality, std::equal_to<> or std::equal_to<T>.
+     * The table takes correspondingly more memory: 64 bytes per slot for the default KeyBytes instead of 16.
+     *
+     * @tparam Base The storage policy for the values, e.g. ValueStorage<std::string> or InlineStringStorage<>.
+     * @tparam KeyBytes The key length, in bytes, up to which keys are held inline at least.
+     */
+    template <typename Base = ValueStorage<std::string>, std::size_t KeyBytes = 23>
+    class SmallKeySlots : public Base
+    {
+    public:
+        using Base::Base;
+
+        static constexpr std::size_t slot_key_bytes = KeyBytes;
+    };
+
+    /**
+     * @brief The Internify class template provides a mechanism for interning objects of type T.
+     *
+     * Interning is a process where identical objects are stored only once in memory,
+     * and all references to these objects point to the same memory location.
+     * This can reduce memory usage and improve performance in cases where many identical objects are used.
+     *
+     * When both HashFunc and KeyEqual are transparent (they define is_transparent, as the defaults do for strings),
+     * internify() and find() also accept any key type they can hash and compare, such as std::string_view for
+     * std::string. A T is only constructed from such a key when it is actually inserted.
+     *
+     * @tparam T The type of objects to be interned. T must be copyable.
+     * @tparam HashFunc A hash function object that takes an object of type T and returns an unsigned integer. Defaults to scc::Hash<T>.
+     *         Entries are confirmed with KeyEqual, so a short or cheap hash only costs extra comparisons on collisions.
+     * @tparam KeyEqual An equality predicate for objects of type T. Defaults to std::equal_to<>.
+     * @tparam Storage The storage policy deciding how interned values are held. Defaults to scc::ValueStorage<T>;
+     *         scc::ArenaStringStorage packs strings into shared chunks and scc::InlineStringStorage puts them into
+     *         their nodes; both hand out string views.
+     */
+    template <typename T, typename HashFunc = Hash<T>, typename KeyEqual = std::equal_to<>, typename Storage = ValueStorage<T>>
+    class Internify
+    {
+        struct InterningNode;
+
+        template <typename K>
+        using EnableIfTransparent = detail::enable_if_heterogeneous_t<HashFunc, KeyEqual, T, K>;
+
+        using StringView = typename detail::string_view_of<T>::type;
+
+        static_assert(!detail::has_slot_keys<Storage>::value ||
+                          (!std::is_void_v<StringView> &&
+                           (std::is_same_v<KeyEqual, std::equal_to<>> || std::is_same_v<KeyEqual, std::equal_to<T>>)),
+                      "SmallKeySlots needs a string T and KeyEqual std::equal_to<> or std::equal_to<T>");
+
+    public:
+        /**
+         * @brief The type of the interned objects handed out, as chosen by the Storage policy; T by default.
+         */
+        using value_type = typename Storage::value_type;
+
+        /**
+         * @brief The type HashFunc produces. Every entry stores its hash, so it is never recomputed.
+         */
+        using HashedValue = decltype(std::declval<HashFunc>()(std::declval<T>()));
+
+        /**
+         * @brief A smart pointer-like object that manages a reference to an interned object.
+         *
+         * This class is responsible for managing the reference count of the interned object and
+         * ensures that the object is only deleted when there are no more references.
+         */
+        class InternedPtr
+        {
+        public:
+            /**
+             * @brief Constructs an invalid InternedPtr, e.g. to presize the output of intern_bulk().
+             */
+            InternedPtr() = default;
+
+            /**
+             * @brief Constructs an InternedPtr that owns one reference to node, which is managed by owner.
+             *
+             * @param owner Pointer to the owning Internify instance.
+             * @param node Pointer to the node holding the interned object.
+             */
+            InternedPtr(Internify *owner, InterningNode *node)
+                : m_owner(owner), m_node(node) {}
+
+            /**
+             * @brief Copy constructor. Shares other's interned object by incrementing its reference count.
+             *
+             * The increment happens on the node alone, or in the thread's buffer with deferred reference counting:
+             * the pool is neither hashed, probed nor locked. It is relaxed because other already holds a reference,
+             * so the count cannot drop to zero concurrently.
+             *
+             * @param other The InternedPtr to share the interned object with.
+             */
+            InternedPtr(const InternedPtr &other) noexcept
+                : m_owner(other.m_owner), m_node(other.m_node)
+            {
+                if (m_node)
+                {
+                    m_owner->addReference(m_node);
+                }
+            }
+
+            /**
+             * @brief Copy assignment operator. Releases the current reference and shares other's interned object.
+             *
+             * @param other The InternedPtr to share the interned object with.
+             * @return InternedPtr& Reference to the current InternedPtr.
+             */
+            InternedPtr &operator=(const InternedPtr &other)
+            {
+                if (m_node != other.m_node)
+                {
+                    InternedPtr copy(other);
+                    release();
+                    m_owner = copy.m_owner;
+                    m_node = copy.m_node;
+                    copy.reset();
+                }
+                return *this;
+            }
+
+            /**
+             * @brief Move constructor. Transfers ownership from other to the new InternedPtr.
+             *
+             * @param other The other InternedPtr to move from.
+             */
+            InternedPtr(InternedPtr &&other) noexcept
+                : m_owner(other.m_owner), m_node(other.m_node)
+            {
+                other.reset();
+            }
+
+            /**
+             * @brief Move assignment operator. Transfers ownership from other to the current InternedPtr.
+             *
+             * @param other The other InternedPtr to move from.
+             * @return InternedPtr& Reference to the current InternedPtr.
+             */
+            InternedPtr &operator=(InternedPtr &&other) noexcept
+            {
+                if (this != &other)
+                {
+                    release();
+                    m_owner = other.m_owner;
+                    m_node = other.m_node;
+                    other.reset();
+                }
+                return *this;
+            }
+
+            /**
+             * @brief Destructor. Decrements the reference count of the interned object and deletes it if no more references exist.
+             */
+            ~InternedPtr()
+            {
+                release();
+            }
+
+            /**
+             * @brief Returns a pointer to the interned object.
+             *
+             * @return const value_type* Pointer to the interned object.
+             */
+            const value_type *get() const { return m_node ? &m_node->value : nullptr; }
+
+            /**
+             * @brief Dereferences the pointer to access the interned object.
+             *
+             * @return const value_type& Reference to the interned object.
+             * @note it is undefined behavior if this instance is not valid.
+             */
+            const value_type &operator*() const { return m_node->value; }
+
+            /**
+             * @brief Returns a pointer to the interned object.
+             *
+             * @return const value_type* Pointer to the interned object.
+             */
+            const value_type *operator->() const { return &m_node->value; }
+
+            /**
+             * @brief Returns the hash stored with the interned object, e.g. to key other containers without rehashing it.
+             *
+             * @return HashedValue The hash of the interned object.
+             * @note it is undefined behavior if this instance is not valid.
+             */
+            HashedValue hash() const { return m_node->hash; }
+
+            /**
+             * @brief Checks if the InternedPtr is valid (i.e., points to an interned object).
+             *
+             * @return true If the InternedPtr is valid, false otherwise.
+             */
+            operator bool() const { return m_node != nullptr && m_owner != nullptr; }
+
+            /**
+             * @brief Returns true if the InternedPtr is valid, false otherwise.
+             *
+             * @return true If the InternedPtr is valid, false otherwise.
+             */
+            bool is_valid() const { return m_node != nullptr && m_owner != nullptr; }
+
+            /**
+             * @brief Compares two InternedPtr objects for equality.
+             *
+             * @param other The other InternedPtr to compare with.
+             * @return true If both InternedPtr objects point to the same interned object.
+             * @return false If the InternedPtr objects point to different interned objects.
+             */
+            bool operator==(const InternedPtr &other) const { return m_node == other.m_node; }
+
+            /**
+             * @brief Compares two InternedPtr objects for inequality.
+             *
+             * @param other The other InternedPtr to compare with.
+             * @return true If the InternedPtr objects point to different interned objects.
+             * @return false If both InternedPtr objects point to the same interned object.
+             */
+            bool operator!=(const InternedPtr &other) const { return m_node != other.m_node; }
+
+            /**
+             * @brief Releases the interned object, decrementing its reference count.
+             *
+             * The count is decremented directly on the node; the owner is only locked when this was the last reference.
+             */
+            void release()
+            {
+                if (m_owner && m_node)
+                {
+                    m_owner->release(m_node);
+                }
+
+                reset();
+            }
+
+        private:
+            friend class Internify;
+
+            /**
+             * @brief Resets the InternedPtr to an invalid state.
+             */
+            void reset()
+            {
+                m_owner = nullptr;
+                m_node = nullptr;
+            }
+
+            Internify *m_owner = nullptr;
+            InterningNode *m_node = nullptr;
+        };
+
+        Internify()
+            : Internify(std::pmr::get_default_resource()) {}
+
+        /**
+         * @brief Constructs an empty intern pool that allocates from resource, e.g. a per-request arena or a NUMA-local resource.
+         *
+         * The resource provides the slot tables, the nodes, the memory of Storage policies that accept a
+         * resource, and the contents of values that use a std::pmr allocator, such as std::pmr::string. The
+         * resource must outlive the pool.
+         *
+         * @param resource The memory resource to allocate from.
+         */
+        explicit Internify(std::pmr::memory_resource *resource)
+            : m_resource(resource), m_counted(resource), m_nodes(&m_counted), m_storage(makeStorage(&m_counted))
+        {
+            // A node retired in one batch is freed two batches later at the earliest, so three batches cover the
+            // steady state and retiring does not reallocate on the release path.
+            m_retired.reserve(3 * kReclaimBatch);
+        }
+
+        /**
+         * @brief Constructs an empty intern pool with deferred reference counting.
+         *
+         * Copying and dropping an InternedPtr, retain() and release(SymbolId), and lock-free hits then record
+         * their +1 or -1 in a buffer of the calling thread instead of writing the entry's shared count, so the
+         * count of a popular entry stops bouncing between cores. Entries whose last reference is dropped are
+         * therefore not erased right away but by the next reconcile(), which also runs whenever the table would
+         * grow and from compact(); until then they still count in size() and can be found again.
+         *
+         * @param resource The memory resource to allocate from. It must outlive the pool.
+         */
+        explicit Internify(DeferredRefCounts, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : Internify(resource)
+        {
+            m_deferred = true;
+        }
+
+        /**
+         * @brief Destructor. Frees every node and every retired table still owned by the intern pool.
+         *
+         * No other thread may access the pool while it is being destroyed.
+         */
+        ~Internify()
+        {
+            if (m_deferred)
+            {
+                detail::DeferredCounts::instance().purge(this);
+            }
+            if (Table *table = m_table.load(std::memory_order_relaxed))
+            {
+                for (std::size_t i = 0; i < table->capacity; ++i)
+                {
+                    InterningNode *node = table->slots[i].node.load(std::memory_order_relaxed);
+                    if (isOccupied(node))
+                    {
+                        deleteNode(*this, node);
+                    }
+                }
+                freeTable(table);
+            }
+            for (const Retired &retired : m_retired)
+            {
+                retired.reclaim(*this, retired.ptr);
+            }
+            for (Table *table : m_keptTables)
+            {
+                freeTable(table);
+            }
+        }
+
+        Internify(const Internify &) = delete;
+        Internify &operator=(const Internify &) = delete;
+
+        /**
+         * @brief Interns the given value. If the value is already interned, returns an InternedPtr pointing to the existing interned object.
+         *
+         * If the value is not already interned, inserts the value into the intern pool and returns an InternedPtr pointing to the newly interned object.
+         * Hits on already interned values do not take any lock.
+         *
+         * @param value The value to be interned.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        [[nodiscard]] InternedPtr internify(const T &value)
+        {
+            return internifyImpl(hashValue(value), value);
+        }
+
+        /**
+         * @brief Interns the given value, moving it into the intern pool if it is not interned yet.
+         *
+         * On a hit value is left untouched. On a miss the new entry is move-constructed from value, so buffers the
+         * caller just built are stolen instead of copied.
+         *
+         * @param value The value to be interned.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        [[nodiscard]] InternedPtr internify(T &&value)
+        {
+            return internifyImpl(hashValue(value), std::move(value));
+        }
+
+        /**
+         * @brief Constructs a T from args and interns it.
+         *
+         * The value is built exactly once and, if it is not interned yet, moved into the intern pool; a hit just
+         * drops it. Prefer the heterogeneous internify() overloads when a key is available that can be looked up
+         * without building a T at all.
+         *
+         * @param args The arguments to construct the T from.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        template <typename... Args>
+        [[nodiscard]] InternedPtr internify_emplace(Args &&...args)
+        {
+            return internify(T(std::forward<Args>(args)...));
+        }
+
+        /**
+         * @brief Interns the value equal to key without constructing a T on a hit.
+         *
+         * Only available when HashFunc and KeyEqual are transparent. On a miss the new entry is constructed from key.
+         *
+         * @param key A key that hashes and compares like the T constructed from it, e.g. a std::string_view.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        [[nodiscard]] InternedPtr internify(const K &key)
+        {
+            return internifyImpl(hashValue(key), key);
+        }
+
+        /**
+         * @brief Interns the string made of the size characters at data, which need not be null-terminated.
+         *
+         * Only available for string types with transparent HashFunc and KeyEqual.
+         *
+         * @param data Pointer to the first character.
+         * @param size The number of characters.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        template <typename View = StringView, typename = EnableIfTransparent<View>>
+        [[nodiscard]] InternedPtr internify(const typename View::value_type *data, std::size_t size)
+        {
+            return internify(View(data, size));
+        }
+
+        /**
+         * @brief Interns the given value using a hash the caller already has, e.g. one carried in a network frame.
+         *
+         * HashFunc is not called. Lookups match on the hash and then on KeyEqual, so every access to an entry has to
+         * use the same hash for it: either always the caller's hash, or always what HashFunc produces.
+         *
+         * @param hash The hash of value.
+         * @param value The value to be interned.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        [[nodiscard]] InternedPtr internify_prehashed(HashedValue hash, const T &value)
+        {
+            return internifyImpl(hash, value);
+        }
+
+        /**
+         * @brief Interns the given value using a precomputed hash, moving it into the pool on a miss.
+         *
+         * @param hash The hash of value.
+         * @param value The value to be interned.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        [[nodiscard]] InternedPtr internify_prehashed(HashedValue hash, T &&value)
+        {
+            return internifyImpl(hash, std::move(value));
+        }
+
+        /**
+         * @brief Interns the value equal to key using a precomputed hash. Only available for transparent pools.
+         *
+         * @param hash The hash of key.
+         * @param key A key that compares like the T constructed from it, e.g. a std::string_view.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        [[nodiscard]] InternedPtr internify_prehashed(HashedValue hash, const K &key)
+        {
+            return internifyImpl(hash, key);
+        }
+
+        /**
+         * @brief Finds the interned object corresponding to value without creating a new entry.
+         *
+         * If the value is not found, returns an invalid InternedPtr. This never takes a lock.
+         *
+         * @param value The value to find in the intern pool.
+         * @return InternedPtr A smart pointer to the interned object, or an invalid InternedPtr if the object is not found.
+         */
+        [[nodiscard]] InternedPtr find(const T &value) const
+        {
+            return findImpl(hashValue(value), value);
+        }
+
+        /**
+         * @brief Finds the interned object equal to key without constructing a T.
+         *
+         * Only available when HashFunc and KeyEqual are transparent.
+         *
+         * @param key A key that hashes and compares like the T constructed from it, e.g. a std::string_view.
+         * @return InternedPtr A smart pointer to the interned object, or an invalid InternedPtr if the object is not found.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        [[nodiscard]] InternedPtr find(const K &key) const
+        {
+            return findImpl(hashValue(key), key);
+        }
+
+        /**
+         * @brief Finds the interned object corresponding to value using a precomputed hash. See internify_prehashed().
+         *
+         * @param hash The hash of value.
+         * @param value The value to find in the intern pool.
+         * @return InternedPtr A smart pointer to the interned object, or an invalid InternedPtr if the object is not found.
+         */
+        [[nodiscard]] InternedPtr find_prehashed(HashedValue hash, const T &value) const
+        {
+            return findImpl(hash, value);
+        }
+
+        /**
+         * @brief Finds the interned object equal to key using a precomputed hash. Only available for transparent pools.
+         *
+         * @param hash The hash of key.
+         * @param key A key that compares like the T constructed from it, e.g. a std::string_view.
+         * @return InternedPtr A smart pointer to the interned object, or an invalid InternedPtr if the object is not found.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        [[nodiscard]] InternedPtr find_prehashed(HashedValue hash, const K &key) const
+        {
+            return findImpl(hash, key);
+        }
+
+        /**
+         * @brief The number of entries in each thread's front cache.
+         */
+        static constexpr std::size_t kFrontCacheSize = 1024;
+
+        /**
+         * @brief The number of erase generations, which tell internify_cached() which cached entries an erase invalidated.
+         */
+        static constexpr std::size_t kEraseStripes = 64;
+
+        /**
+         * @brief Calls fn with the interned object equal to value, without taking a reference.
+         *
+         * For code that only looks at the object briefly, e.g. to compare or hash it. The lookup runs inside an
+         * epoch, which keeps the object alive until fn returns, so neither the lookup nor fn writes to any shared
+         * cache line. fn must not keep the reference beyond its return, nor intern or release entries of this pool.
+         *
+         * @param value The value to look up.
+         * @param fn A callable taking a const value_type &.
+         * @return true If value was interned and fn was called.
+         */
+        template <typename Fn>
+        bool with_interned(const T &value, Fn &&fn) const
+        {
+            return withInterned(hashValue(value), value, std::forward<Fn>(fn));
+        }
+
+        /**
+         * @brief Calls fn with the interned object equal to key, without taking a reference. Only available for transparent pools.
+         *
+         * @param key A key that hashes and compares like the T constructed from it, e.g. a std::string_view.
+         * @param fn A callable taking a const value_type &.
+         * @return true If key was interned and fn was called.
+         */
+        template <typename K, typename Fn, typename = EnableIfTransparent<K>>
+        bool with_interned(const K &key, Fn &&fn) const
+        {
+            return withInterned(hashValue(key), key, std::forward<Fn>(fn));
+        }
+
+        /**
+         * @brief Returns the interned object equal to value, borrowed for as long as guard lives.
+         *
+         * No reference is taken. The object may be erased in the meantime, but its memory is not freed before the
+         * guard is destroyed. The guard must have been created on the calling thread, and the pointer must only be
+         * used on that thread: a guard held by another thread does not protect it. Debug builds assert the former.
+         *
+         * @param guard The guard that keeps the object alive; created on the calling thread.
+         * @param value The value to look up.
+         * @return const value_type* The interned object, or nullptr if value is not interned.
+         */
+        const value_type *borrow(const ReadGuard &guard, const T &value) const
+        {
+            return borrowImpl(guard, hashValue(value), value);
+        }
+
+        /**
+         * @brief Returns the interned object equal to key, borrowed for as long as guard lives. Only available for transparent pools.
+         *
+         * @param guard The guard that keeps the object alive; created on the calling thread.
+         * @param key A key that hashes and compares like the T constructed from it, e.g. a std::string_view.
+         * @return const value_type* The interned object, or nullptr if key is not interned.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        const value_type *borrow(const ReadGuard &guard, const K &key) const
+        {
+            return borrowImpl(guard, hashValue(key), key);
+        }
+
+        /**
+         * @brief Interns the given value through the calling thread's front cache.
+         *
+         * The front cache is a small direct-mapped array per thread, indexed by hash, that remembers the nodes the
+         * thread interned recently. A cache hit checks the node against value and takes its reference without
+         * probing the table. An erase invalidates, in every thread, the cached entries of the pool whose hashes
+         * share the erased value's erase stripe: one of kEraseStripes groups picked by hash bits, each with its own
+         * generation. A pool that keeps erasing values at a steady rate therefore costs each thread about one miss
+         * per erase for the stripe it hit, and the hot values in other stripes stay cached (see the churn cases of
+         * profile/bench_front_cache). All pools of one type share a thread's kFrontCacheSize entries, 32 KiB per
+         * thread.
+         *
+         * @param value The value to be interned.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        [[nodiscard]] InternedPtr internify_cached(const T &value)
+        {
+            return internifyCached(hashValue(value), value);
+        }
+
+        /**
+         * @brief Interns the value equal to key through the calling thread's front cache. Only available for transparent pools.
+         *
+         * @param key A key that hashes and compares like the T constructed from it, e.g. a std::string_view.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        [[nodiscard]] InternedPtr internify_cached(const K &key)
+        {
+            return internifyCached(hashValue(key), key);
+        }
+
+        /**
+         * @brief Returns the hit and miss counts of the calling thread's front cache, over all pools of this type.
+         *
+         * @return FrontCacheStats The counters since the thread started or last called reset_front_cache_stats().
+         */
+        static FrontCacheStats front_cache_stats() { return frontCache().stats; }
+
+        /**
+         * @brief Resets the calling thread's front cache counters.
+         */
+        static void reset_front_cache_stats() { frontCache().stats = {}; }
+
+        /**
+         * @brief Interns every value in [first, last) in parallel and writes the results to out, in input order.
+         *
+         * The input is cut into chunks of a few thousand values, which the calling thread and the workers of a
+         * process-wide work-stealing pool intern concurrently; small batches stay on the calling thread. Hits take
+         * no lock and scale with the threads, but misses still serialize on this pool's exclusive lock, so for
+         * batches of mostly new values ShardedInternify::intern_bulk() is the better fit.
+         *
+         * Not to be called from inside another intern_bulk() on the same thread, e.g. from a hash function.
+         *
+         * @param first The beginning of a random-access range of T or, for transparent pools, of keys.
+         * @param last The end of the range.
+         * @param out The beginning of a random-access range of at least last - first InternedPtr, which receive
+         *            handles, or SymbolId, which receive ids. If interning throws, some may already be assigned.
+         */
+        template <typename InputIt, typename OutputIt>
+        void intern_bulk(InputIt first, InputIt last, OutputIt out)
+        {
+            using Output = std::decay_t<decltype(*out)>;
+            static_assert(std::is_same_v<Output, InternedPtr> || std::is_same_v<Output, SymbolId>,
+                          "intern_bulk() writes InternedPtr or SymbolId");
+
+            const auto count = static_cast<std::size_t>(std::distance(first, last));
+            detail::forEachChunk(count, [&](std::size_t begin, std::size_t end)
+                                 {
+                                     for (std::size_t i = begin; i < end; ++i)
+                                     {
+                                         const auto &value = first[i];
+                                         InternedPtr ptr = internify_prehashed(hashValue(value), value);
+                                         if constexpr (std::is_same_v<Output, SymbolId>)
+                                         {
+                                             out[i] = to_id(std::move(ptr));
+                                         }
+                                         else
+                                         {
+                                             out[i] = std::move(ptr);
+                                         }
+                                     } });
+        }
+
+        /**
+         * @brief Interns the given value and returns its SymbolId instead of an InternedPtr.
+         *
+         * The id owns one reference, which is dropped with release(SymbolId).
+         *
+         * @param value The value to be interned.
+         * @return SymbolId The id of the interned object.
+         */
+        [[nodiscard]] SymbolId internify_id(const T &value)
+        {
+            return to_id(internify(value));
+        }
+
+        /**
+         * @brief Interns the given value, moving it into the pool on a miss, and returns its SymbolId.
+         *
+         * @param value The value to be interned.
+         * @return SymbolId The id of the interned object.
+         */
+        [[nodiscard]] SymbolId internify_id(T &&value)
+        {
+            return to_id(internify(std::move(value)));
+        }
+
+        /**
+         * @brief Interns the value equal to key and returns its SymbolId. Only available for transparent pools.
+         *
+         * @param key A key that hashes and compares like the T constructed from it, e.g. a std::string_view.
+         * @return SymbolId The id of the interned object.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        [[nodiscard]] SymbolId internify_id(const K &key)
+        {
+            return to_id(internify(key));
+        }
+
+        /**
+         * @brief Turns a handle into the SymbolId of its object; the handle's reference passes to the id.
+         *
+         * An object gets its id the first time one is asked for, under the exclusive lock. From then on this
+         * only reads the id stored with the object.
+         *
+         * @param ptr A handle obtained from this pool. It is left invalid.
+         * @return SymbolId The id of the interned object, or kNoSymbol if ptr is invalid.
+         */
+        [[nodiscard]] SymbolId to_id(InternedPtr &&ptr)
+        {
+            return toId(std::move(ptr), ~SymbolId{0});
+        }
+
+        /**
+         * @brief Returns the interned object named by id. Never takes a lock.
+         *
+         * @param id An id that currently owns a reference in this pool.
+         * @return const value_type& Reference to the interned object.
+         */
+        const value_type &resolve(SymbolId id) const
+        {
+            return m_symbols[id]->value;
+        }
+
+        /**
+         * @brief Adds a reference to the object named by id, so that id has to be released once more.
+         *
+         * @param id An id that currently owns a reference in this pool.
+         */
+        void retain(SymbolId id)
+        {
+            addReference(m_symbols[id]);
+        }
+
+        /**
+         * @brief Drops one reference owned by id. Once the last one is gone the object is erased and id may be reused.
+         *
+         * @param id An id that currently owns a reference in this pool.
+         */
+        void release(SymbolId id)
+        {
+            release(m_symbols[id]);
+        }
+
+        /**
+         * @brief Returns the number of unique interned objects currently stored in the intern pool.
+         *
+         * @return std::size_t The number of interned objects.
+         */
+        std::size_t size() const
+        {
+            std::shared_lock lock(m_mutex);
+            return m_size - m_zombies.size();
+        }
+
+        /**
+         * @brief Returns what the pool currently costs.
+         *
+         * The entry counts and byte figures are kept up to date by inserts and erasures and are copied under the
+         * shared lock in O(1). total_references is not tallied on the hot paths, so that taking and dropping
+         * references stays free of shared counters: it is summed afterwards over the published table, like a
+         * lock-free lookup, which costs O(capacity) but never blocks inserts or erasures. With deferred reference
+         * counting the threads' pending changes are added too, locking each thread's buffer for a moment. While
+         * other threads are interning, total_references is a snapshot rather than an exact figure.
+         *
+         * @return MemoryStats The current figures.
+         */
+        MemoryStats memory_stats() const
+        {
+            MemoryStats stats;
+            {
+                std::shared_lock lock(m_mutex);
+                stats.live_entries = m_size - m_zombies.size();
+                stats.zombie_entries = m_zombies.size();
+                stats.value_bytes = m_contentBytes;
+                stats.node_bytes = m_size * sizeof(InterningNode) - m_inNodeBytes;
+                stats.table_bytes = m_tableBytes;
+                const std::size_t held = m_counted.allocated_bytes() + m_externalBytes;
+                const std::size_t accounted = stats.value_bytes + stats.node_bytes + stats.table_bytes;
+                stats.slack_bytes = held > accounted ? held - accounted : 0;
+            }
+            stats.total_references = countReferences();
+            stats.dedup_ratio = stats.live_entries ? static_cast<double>(stats.total_references) / static_cast<double>(stats.live_entries) : 0;
+            return stats;
+        }
+
+        /**
+         * @brief Calls fn with every interned object, in table order, while holding the shared lock.
+         *
+         * fn must not intern or release entries of this pool.
+         *
+         * @param fn A callable taking a const value_type &.
+         */
+        template <typename Fn>
+        void for_each(Fn &&fn) const
+        {
+            std::shared_lock lock(m_mutex);
+            if (const Table *table = m_table.load(std::memory_order_relaxed))
+            {
+                for (std::size_t i = 0; i < table->capacity; ++i)
+                {
+                    const InterningNode *node = table->slots[i].node.load(std::memory_order_relaxed);
+                    if (isOccupied(node) && !isZombie(node))
+                    {
+                        fn(node->value);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Sets how many released entries the pool keeps as zombies, so that interning them again is cheap.
+         *
+         * When the last reference to an entry is dropped, the entry normally leaves the table and its node is
+         * freed. With a budget, it stays in the table as a zombie instead: lookups skip it, and the next
+         * internify() of the same value brings it back under the lock without allocating, constructing the value
+         * or touching the table. Once the budget is used up, each new zombie evicts an older one. Zombies are
+         * also evicted by sweep_zombies(), compact() and shrink_to_fit(), and count towards the table's load, so
+         * the table grows to hold them. The default budget is 0. Pools with deferred reference counting keep no
+         * zombies, since they already erase in reconcile().
+         *
+         * @param budget The maximum number of zombies. Lowering it evicts the excess right away.
+         */
+        void set_zombie_budget(std::size_t budget)
+        {
+            std::unique_lock lock(m_mutex);
+            m_zombieBudget = m_deferred ? 0 : budget;
+            while (m_zombies.size() > m_zombieBudget)
+            {
+                evictZombie();
+            }
+        }
+
+        /**
+         * @brief Erases every zombie, see set_zombie_budget().
+         *
+         * @return std::size_t The number of zombies erased.
+         */
+        std::size_t sweep_zombies()
+        {
+            std::unique_lock lock(m_mutex);
+            return sweepZombies();
+        }
+
+        /**
+         * @brief Erases the entries whose last reference has been dropped, in a pool with deferred reference counting.
+         *
+         * Writes every thread's buffered changes for this pool back to the counts and erases the entries that end
+         * up at zero. While the counts are checked, every thread that copies or drops a handle of any deferred pool
+         * waits, so this is an O(table size) pause rather than something to call per operation. Does nothing in a
+         * pool with immediate reference counting.
+         *
+         * @return std::size_t The number of entries erased.
+         */
+        std::size_t reconcile()
+        {
+            std::unique_lock lock(m_mutex);
+            return reconcileLocked();
+        }
+
+        /**
+         * @brief Shrinks the slot table to the smallest size that fits the live entries, e.g. after a mass release.
+         *
+         * Only the slot array is rebuilt; nodes stay where they are, so every InternedPtr and SymbolId remains valid.
+         * An empty pool drops its table altogether. The old table is freed once no lock-free reader can see it.
+         */
+        void shrink_to_fit()
+        {
+            std::unique_lock lock(m_mutex);
+            sweepZombies();
+            shrinkTable();
+        }
+
+        /**
+         * @brief Returns as much memory as possible without moving any interned object.
+         *
+         * Shrinks the table like shrink_to_fit(), frees erased entries that no reader can see anymore, returns
+         * node slabs without live nodes, and lets the Storage free what it keeps for reuse, such as empty arena
+         * chunks. Interned objects are never relocated, so every InternedPtr, SymbolId and view stays valid;
+         * a slab or chunk that still holds one live entry is kept.
+         */
+        void compact()
+        {
+            std::unique_lock lock(m_mutex);
+            reconcileLocked();
+            sweepZombies();
+            shrinkTable();
+            // Entries are safe two epochs after they were retired; without readers in flight this frees all of them.
+            detail::EpochDomain::instance().tryAdvance();
+            reclaimRetired();
+            if constexpr (!detail::has_inline_payload<Storage>::value)
+            {
+                m_nodes.trim([this](auto &&visit)
+                             { forEachAllocatedNode(visit); });
+            }
+            m_storage.compact();
+        }
+
+        /**
+         * @brief Enables or disables shrinking the table automatically once most entries have been released.
+         *
+         * When enabled, erasing an entry that leaves the table less than one-eighth full rebuilds it at the size
+         * shrink_to_fit() would choose, which is at most half full. The table grows once it is three-quarters full,
+         * and a grown table starts about three-eighths full, so neither a shrunk nor a grown table is near the other
+         * threshold and the size does not oscillate. Disabled by default.
+         *
+         * @param enabled Whether to shrink automatically.
+         */
+        void set_auto_shrink(bool enabled)
+        {
+            std::unique_lock lock(m_mutex);
+            m_autoShrink = enabled;
+        }
+
+    private:
+        template <typename, typename, typename, std::size_t, typename>
+        friend class ShardedInternify;
+
+        template <typename, typename, typename, typename>
+        friend class ImmortalInternify;
+
+        /**
+         * @brief Constructs the pool behind an ImmortalInternify: replaced tables are kept until destruction.
+         */
+        Internify(detail::ImmortalTag, std::pmr::memory_resource *resource)
+            : Internify(resource)
+        {
+            m_immortal = true;
+        }
+
+        /**
+         * @brief Takes the reference owned by ptr away from it without dropping it.
+         */
+        static InterningNode *detach(InternedPtr &ptr)
+        {
+            InterningNode *node = ptr.m_node;
+            ptr.reset();
+            return node;
+        }
+
+        struct InterningNode
+        {
+            template <typename K>
+            InterningNode(HashedValue h, std::pmr::memory_resource *resource, K &&key)
+                : value(makeValue(resource, std::forward<K>(key))), refCount(1), hash(h) {}
+
+            const value_type value;
+            std::atomic<int> refCount;
+            std::atomic<SymbolId> id{kNoSymbol}; // assigned on first request, see toId()
+            const HashedValue hash;              // cached so that erasing and rehashing never run HashFunc again
+        };
+
+        struct SlotHeader
+        {
+            std::atomic<InterningNode *> node;
+            HashedValue hash;
+        };
+
+        /**
+         * @brief Returns the number of key characters a slot holds inline; 0 unless Storage asks for SmallKeySlots.
+         */
+        template <typename View = StringView>
+        static constexpr std::size_t slotKeyChars()
+        {
+            if constexpr (detail::has_slot_keys<Storage>::value)
+            {
+                return detail::slotKeyChars<typename View::value_type>(Storage::slot_key_bytes, sizeof(SlotHeader));
+            }
+            else
+            {
+                return 0;
+            }
+        }
+
+        using SlotKey = detail::SlotKey<StringView, slotKeyChars()>;
+
+        template <typename View = StringView>
+        static constexpr std::size_t slotAlignment()
+        {
+            if constexpr (detail::has_slot_keys<Storage>::value)
+            {
+                const std::size_t bytes = sizeof(SlotHeader) + (slotKeyChars() + 1) * sizeof(typename View::value_type);
+                return std::min(bytes, detail::kCacheLineSize);
+            }
+            else
+            {
+                return alignof(SlotHeader);
+            }
+        }
+
+        static constexpr std::size_t kSlotAlignment = slotAlignment();
+
+        /**
+         * @brief One entry of the open-addressing table.
+         *
+         * The hash sits next to the node pointer and acts as a tag: a probe compares hashes without leaving the
+         * slot array and only runs KeyEqual on the nodes whose hash matches. Nodes are allocated separately and
+         * never move, which keeps the addresses held by InternedPtr valid while the slot array is rehashed.
+         * With SmallKeySlots, the SlotKey base also holds a copy of a short key, see keyMatches().
+         *
+         * A slot is written at most once per table: hash and key first, then the node pointer with release
+         * semantics. Erasing only swaps the node pointer for tombstone(), and tombstones are not reused until the
+         * next rehash builds a new table, so lock-free readers always see a hash and key that belong to the node
+         * they loaded.
+         */
+        struct alignas(kSlotAlignment) Slot : SlotKey
+        {
+            std::atomic<InterningNode *> node{nullptr}; // nullptr marks an empty slot, tombstone() an erased one
+            HashedValue hash{};
+        };
+
+        /**
+         * @brief A slot array together with its geometry, published to readers as a whole.
+         *
+         * The slots follow the header in the same allocation, see newTable().
+         */
+        struct Table
+        {
+            Table(std::size_t cap, Slot *s)
+                : capacity(cap), shift(64), slots(s)
+            {
+                for (std::size_t c = cap; c > 1; c >>= 1)
+                {
+                    --shift;
+                }
+            }
+
+            const std::size_t capacity; // always a power of two
+            unsigned shift;             // 64 - log2(capacity), used by slotIndex()
+            Slot *const slots;
+        };
+
+        static constexpr std::size_t kSlotsOffset = (sizeof(Table) + alignof(Slot) - 1) / alignof(Slot) * alignof(Slot);
+        static constexpr std::size_t kTableAlignment = std::max(alignof(Table), alignof(Slot));
+
+        /**
+         * @brief Memory unlinked from the table that readers may still be looking at.
+         */
+        struct Retired
+        {
+            void *ptr;
+            void (*reclaim)(Internify &, void *);
+            std::uint64_t epoch;
+        };
+
+        static constexpr std::size_t kMinCapacity = 16;
+        static constexpr std::size_t kReclaimBatch = 32;
+
+        /**
+         * @brief Where a lock-free probe ended, so that a following insert can skip probing again.
+         */
+        struct ProbeEnd
+        {
+            const Table *table = nullptr;
+            std::size_t emptySlot = kNoSlot; // the empty slot that ended the probe, or kNoSlot
+        };
+
+        static constexpr std::size_t kNoSlot = ~std::size_t{0};
+
+        /**
+         * @brief Shared implementation of the internify() overloads.
+         *
+         * The hash computed by the caller serves both phases. The lock-free probe either finds the entry or tells
+         * insertNew() where it stopped; insertNew() then takes the exclusive lock and either commits at that slot
+         * or probes again. Both phases run in one epoch, so the probed table cannot be freed and its address
+         * reused in between.
+         */
+        template <typename K>
+        InternedPtr internifyImpl(HashedValue hash, K &&value)
+        {
+            detail::EpochDomain::Guard guard;
+            ProbeEnd probeEnd;
+            InterningNode *existing = findExisting(hash, value, &probeEnd);
+            if (existing)
+            {
+                return InternedPtr(this, existing);
+            }
+            return InternedPtr(this, insertNew(hash, std::forward<K>(value), probeEnd));
+        }
+
+        template <typename K, typename Fn>
+        bool withInterned(HashedValue hash, const K &value, Fn &&fn) const
+        {
+            detail::EpochDomain::Guard guard;
+            const InterningNode *node = probe(hash, value);
+            if (node && !isZombie(node))
+            {
+                std::forward<Fn>(fn)(std::as_const(node->value));
+                return true;
+            }
+            return false;
+        }
+
+        template <typename K>
+        const value_type *borrowImpl([[maybe_unused]] const ReadGuard &guard, HashedValue hash, const K &value) const
+        {
+            assert(guard.m_guard.ownedByCallingThread() && "borrow() needs a ReadGuard created on the calling thread");
+            const InterningNode *node = probe(hash, value);
+            return node && !isZombie(node) ? &node->value : nullptr;
+        }
+
+        /**
+         * @brief Shared implementation of the find() overloads.
+         */
+        template <typename K>
+        InternedPtr findImpl(HashedValue hash, const K &value) const
+        {
+            InterningNode *existing = findExisting(hash, value);
+            if (existing)
+            {
+                return InternedPtr(const_cast<Internify *>(this), existing);
+            }
+            return InternedPtr(nullptr, nullptr);
+        }
+
+        static constexpr unsigned kFrontCacheBits = detail::bitWidth(kFrontCacheSize - 1);
+        static constexpr unsigned kEraseStripeBits = detail::bitWidth(kEraseStripes - 1);
+
+        /**
+         * @brief Scrambles hash for the front cache; its top bits pick both the cache entry and the erase stripe.
+         */
+        static std::uint64_t frontCacheMix(HashedValue hash) { return static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull; }
+
+        /**
+         * @brief Returns the generation that erasing a node with the given hash bumps.
+         */
+        std::atomic<std::uint64_t> &eraseGeneration(HashedValue hash) const
+        {
+            return m_eraseGenerations[static_cast<std::size_t>(frontCacheMix(hash) >> (64 - kEraseStripeBits))];
+        }
+
+        /**
+         * @brief A thread's front cache: which node each hash bucket last resolved to, in which pool and generation.
+         */
+        struct FrontCache
+        {
+            struct Entry
+            {
+                std::uint64_t pool = 0;
+                HashedValue hash{};
+                std::uint64_t generation = 0; // of the erase stripe of hash
+                InterningNode *node = nullptr;
+            };
+
+            std::array<Entry, kFrontCacheSize> entries{};
+            FrontCacheStats stats;
+        };
+
+        static FrontCache &frontCache()
+        {
+            static thread_local FrontCache cache;
+            return cache;
+        }
+
+        /**
+         * @brief Shared implementation of the internify_cached() overloads.
+         *
+         * An entry is only trusted for its own hash, and only while the erase stripe of that hash still has the
+         * generation the entry was filled with: no node with a hash in that stripe, the cached one included, has
+         * been erased since then, so the node cannot have been freed. Both are checked before the node is read.
+         * The epoch guard keeps it allocated even if it is erased while the check runs, and acquire() then
+         * refuses it.
+         */
+        template <typename K>
+        InternedPtr internifyCached(HashedValue hash, const K &value)
+        {
+            FrontCache &cache = frontCache();
+            typename FrontCache::Entry &entry = cache.entries[static_cast<std::size_t>(frontCacheMix(hash) >> (64 - kFrontCacheBits))];
+            std::atomic<std::uint64_t> &generation = eraseGeneration(hash);
+            detail::EpochDomain::Guard guard;
+            if (entry.pool == m_id && entry.hash == hash && entry.generation == generation.load(std::memory_order_acquire) &&
+                KeyEqual{}(entry.node->value, value) && acquire(entry.node))
+            {
+                ++cache.stats.hits;
+                return InternedPtr(this, entry.node);
+            }
+            ++cache.stats.misses;
+            InternedPtr ptr = internifyImpl(hash, value);
+            // The handle keeps the node from being erased, so a generation read now can only be too old, never too new.
+            entry = {m_id, hash, generation.load(std::memory_order_acquire), ptr.m_node};
+            return ptr;
+        }
+
+        /**
+         * @brief Drops one reference to node.
+         *
+         * Decrements that leave other references behind are a plain CAS on the node. Only the final reference
+         * takes the exclusive lock, and the decrement is repeated under it: a lock-free hit may have taken a new
+         * reference in the meantime, in which case the node stays in the pool.
+         *
+         * @param node The node whose reference count should be decremented.
+         */
+        void release(InterningNode *node)
+        {
+            if (m_deferred)
+            {
+                detail::DeferredCounts::instance().add(this, &node->refCount, -1);
+                return;
+            }
+
+            int count = node->refCount.load(std::memory_order_relaxed);
+            while (count > 1)
+            {
+                if (node->refCount.compare_exchange_weak(count, count - 1, std::memory_order_release, std::memory_order_relaxed))
+                {
+                    return;
+                }
+            }
+
+            std::unique_lock lock(m_mutex);
+            if (node->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                if (m_zombieBudget == 0)
+                {
+                    erase(node);
+                    return;
+                }
+                if (m_zombies.size() == m_zombieBudget)
+                {
+                    evictZombie();
+                }
+                bury(node);
+            }
+        }
+
+        /**
+         * @brief Returns true if node is a zombie, see set_zombie_budget().
+         *
+         * A zombie's count holds its position in m_zombies as -(index + 1). Lock-free hits only take a reference
+         * while the count is positive, so they pass zombies by like nodes that are being erased.
+         */
+        bool isZombie(const InterningNode *node) const
+        {
+            return !m_deferred && node->refCount.load(std::memory_order_relaxed) < 0;
+        }
+
+        /**
+         * @brief Keeps a node whose count just dropped to zero in the table as a zombie. The caller must hold m_mutex exclusively.
+         */
+        void bury(InterningNode *node)
+        {
+            m_zombies.push_back(node);
+            node->refCount.store(-static_cast<int>(m_zombies.size()), std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Takes a zombie out of m_zombies, leaving its count at zero. The caller must hold m_mutex exclusively.
+         */
+        void unbury(InterningNode *node)
+        {
+            const std::size_t index = static_cast<std::size_t>(-node->refCount.load(std::memory_order_relaxed) - 1);
+            InterningNode *last = m_zombies.back();
+            m_zombies[index] = last;
+            last->refCount.store(-static_cast<int>(index + 1), std::memory_order_relaxed);
+            m_zombies.pop_back();
+            node->refCount.store(0, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Erases one zombie, round-robin over m_zombies. The caller must hold m_mutex exclusively.
+         */
+        void evictZombie()
+        {
+            m_zombieCursor = m_zombieCursor < m_zombies.size() ? m_zombieCursor : 0;
+            InterningNode *node = m_zombies[m_zombieCursor++];
+            unbury(node);
+            erase(node);
+        }
+
+        /**
+         * @brief Erases every zombie. The caller must hold m_mutex exclusively.
+         */
+        std::size_t sweepZombies()
+        {
+            const std::size_t count = m_zombies.size();
+            while (!m_zombies.empty())
+            {
+                InterningNode *node = m_zombies.back();
+                unbury(node);
+                erase(node);
+            }
+            return count;
+        }
+
+        /**
+         * @brief Adds a reference to node on behalf of a caller that already holds one.
+         *
+         * A relaxed increment is enough, because the caller's reference keeps the count from reaching zero.
+         */
+        void addReference(InterningNode *node)
+        {
+            if (m_deferred)
+            {
+                detail::DeferredCounts::instance().add(this, &node->refCount, 1);
+            }
+            else
+            {
+                node->refCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief Sums the reference counts of the live entries for memory_stats(), without taking m_mutex.
+         *
+         * Walks the published table inside an epoch, as probe() does, so neither the table nor a node erased
+         * meanwhile is freed under it.
+         */
+        std::size_t countReferences() const
+        {
+            std::int64_t total = m_deferred ? detail::DeferredCounts::instance().pending(this) : 0;
+            detail::EpochDomain::Guard guard;
+            if (const Table *table = m_table.load(std::memory_order_acquire))
+            {
+                for (std::size_t i = 0; i < table->capacity; ++i)
+                {
+                    const InterningNode *node = table->slots[i].node.load(std::memory_order_acquire);
+                    if (isOccupied(node))
+                    {
+                        // Zombies and dead deferred nodes have negative counts; deferred counts may dip below
+                        // zero only while pending changes make up for it.
+                        const int count = node->refCount.load(std::memory_order_relaxed);
+                        if (m_deferred ? count != detail::DeferredCounts::kDead : count > 0)
+                        {
+                            total += count;
+                        }
+                    }
+                }
+            }
+            return static_cast<std::size_t>(std::max<std::int64_t>(total, 0));
+        }
+
+        /**
+         * @brief Takes a reference on a node found by a lock-free probe, unless it is being erased.
+         */
+        bool acquire(InterningNode *node) const
+        {
+            return m_deferred ? detail::DeferredCounts::instance().tryAcquire(this, &node->refCount) : tryAcquire(node);
+        }
+
+        /**
+         * @brief Erases the nodes without references in a deferred pool. The caller must hold m_mutex exclusively.
+         *
+         * @return std::size_t The number of nodes erased.
+         */
+        std::size_t reconcileLocked()
+        {
+            Table *table = m_table.load(std::memory_order_relaxed);
+            if (!m_deferred || !table)
+            {
+                return 0;
+            }
+            std::vector<InterningNode *> dead;
+            detail::DeferredCounts::instance().reconcile(this, [table, &dead]
+                                                         {
+                                                             for (std::size_t i = 0; i < table->capacity; ++i)
+                                                             {
+                                                                 InterningNode *node = table->slots[i].node.load(std::memory_order_relaxed);
+                                                                 int zero = 0;
+                                                                 if (isOccupied(node) &&
+                                                                     node->refCount.compare_exchange_strong(zero, detail::DeferredCounts::kDead, std::memory_order_acquire))
+                                                                 {
+                                                                     dead.push_back(node);
+                                                                 }
+                                                             } });
+            for (InterningNode *node : dead)
+            {
+                erase(node);
+            }
+            return dead.size();
+        }
+
+        /**
+         * @brief Unlinks a node whose count dropped to zero and retires it. The caller must hold m_mutex exclusively.
+         *
+         * @param node The node to erase.
+         */
+        void erase(InterningNode *node)
+        {
+            Table *table = m_table.load(std::memory_order_relaxed);
+            for (std::size_t i = slotIndex(*table, node->hash);; i = (i + 1) & (table->capacity - 1))
+            {
+                Slot &slot = table->slots[i];
+                if (slot.node.load(std::memory_order_relaxed) == node)
+                {
+                    slot.node.store(tombstone(), std::memory_order_release);
+                    break;
+                }
+            }
+            if (const SymbolId id = node->id.load(std::memory_order_relaxed))
+            {
+                m_symbols.free(id);
+            }
+            // Until it is reclaimed the node only counts as slack.
+            const detail::ValueFootprint footprint = detail::footprintOf(node->value);
+            m_contentBytes -= footprint.content;
+            m_inNodeBytes -= footprint.inNode;
+            --m_size;
+            eraseGeneration(node->hash).fetch_add(1, std::memory_order_release); // before the node can be freed, see internifyCached()
+            retire(node, &deleteNode);
+
+            if (m_autoShrink && table->capacity > kMinCapacity && m_size * 8 < table->capacity)
+            {
+                rehash(fitCapacity(m_size));
+            }
+        }
+
+        /**
+         * @brief Rebuilds the table at the size that fits m_size, or drops it if the pool is empty. The caller must hold m_mutex exclusively.
+         */
+        void shrinkTable()
+        {
+            Table *table = m_table.load(std::memory_order_relaxed);
+            if (!table)
+            {
+                return;
+            }
+            if (m_size == 0)
+            {
+                m_table.store(nullptr, std::memory_order_release);
+                dropTable(table);
+                m_used = 0;
+            }
+            else if (fitCapacity(m_size) < table->capacity || m_used > m_size)
+            {
+                rehash(fitCapacity(m_size));
+            }
+        }
+
+        /**
+         * @brief Returns whether used slots, live entries plus tombstones, are more than the table may hold.
+         *
+         * Linear probing over 16-byte slots stays at about one cache line per hit up to this load: at 3/4 a miss
+         * scans 8.5 slots on average, against 32.5 at 7/8.
+         */
+        static bool overloaded(std::size_t used, std::size_t capacity)
+        {
+            return used * 4 > capacity * 3;
+        }
+
+        /**
+         * @brief Returns the smallest capacity that holds size entries at most half full.
+         *
+         * Rehashes aim here and grow at overloaded(), so a rebuilt table takes at least size / 2 inserts to grow again.
+         */
+        static std::size_t fitCapacity(std::size_t size)
+        {
+            std::size_t capacity = kMinCapacity;
+            while (capacity < size * 2)
+            {
+                capacity *= 2;
+            }
+            return capacity;
+        }
+
+        /**
+         * @brief Calls visit with every node that is allocated: the live ones and those awaiting reclamation.
+         */
+        template <typename Visit>
+        void forEachAllocatedNode(Visit &visit) const
+        {
+            if (const Table *table = m_table.load(std::memory_order_relaxed))
+            {
+                for (std::size_t i = 0; i < table->capacity; ++i)
+                {
+                    const InterningNode *node = table->slots[i].node.load(std::memory_order_relaxed);
+                    if (isOccupied(node))
+                    {
+                        visit(static_cast<const void *>(node));
+                    }
+                }
+            }
+            for (const Retired &retired : m_retired)
+            {
+                if (retired.reclaim == &deleteNode)
+                {
+                    visit(static_cast<const void *>(retired.ptr));
+                }
+            }
+        }
+
+        /**
+         * @brief Implementation of to_id() that refuses to hand out new ids above maxId.
+         */
+        SymbolId toId(InternedPtr &&ptr, SymbolId maxId)
+        {
+            InterningNode *node = ptr.m_node;
+            if (!node)
+            {
+                return kNoSymbol;
+            }
+
+            SymbolId id = node->id.load(std::memory_order_acquire);
+            if (id == kNoSymbol)
+            {
+                std::unique_lock lock(m_mutex);
+                id = node->id.load(std::memory_order_relaxed);
+                if (id == kNoSymbol)
+                {
+                    id = m_symbols.assign(node, maxId);
+                    node->id.store(id, std::memory_order_release);
+                }
+            }
+            ptr.reset();
+            return id;
+        }
+
+        /**
+         * @brief Finds an existing interned object corresponding to value.
+         *
+         * If found, increments the reference count. The probe runs inside an epoch instead of under m_mutex, so
+         * concurrent hits never write to a shared cache line other than the node's reference count.
+         *
+         * @param hash The hash of value.
+         * @param value The value to find; either a T or a transparent key.
+         * @param probeEnd If not null, receives the table and the empty slot at which a miss stopped.
+         * @return InterningNode* The node holding the interned object, or nullptr if the object is not found.
+         */
+        template <typename K>
+        InterningNode *findExisting(HashedValue hash, const K &value, ProbeEnd *probeEnd = nullptr) const
+        {
+            detail::EpochDomain::Guard guard;
+            InterningNode *node = probe(hash, value, probeEnd);
+            // A zero count means the node is being erased, which makes it as good as absent.
+            if (!node || !acquire(node))
+            {
+                return nullptr;
+            }
+            return node;
+        }
+
+        /**
+         * @brief Probes the published table for value without taking a reference.
+         *
+         * The caller must keep the table and the node alive, normally by being inside an epoch.
+         *
+         * @param hash The hash of value.
+         * @param value The value to find; either a T or a transparent key.
+         * @param probeEnd If not null, receives the table and the empty slot at which a miss stopped.
+         * @return InterningNode* The node holding value, or nullptr if the object is not found.
+         */
+        template <typename K>
+        InterningNode *probe(HashedValue hash, const K &value, ProbeEnd *probeEnd = nullptr) const
+        {
+            const Table *table = m_table.load(std::memory_order_acquire);
+            if (!table)
+            {
+                return nullptr;
+            }
+
+            for (std::size_t i = slotIndex(*table, hash);; i = (i + 1) & (table->capacity - 1))
+            {
+                const Slot &slot = table->slots[i];
+                InterningNode *node = slot.node.load(std::memory_order_acquire);
+                if (node == nullptr)
+                {
+                    if (probeEnd)
+                    {
+                        *probeEnd = {table, i};
+                    }
+                    return nullptr;
+                }
+                if (node != tombstone() && slot.hash == hash && keyMatches(slot, node, value))
+                {
+                    return node;
+                }
+            }
+        }
+
+        /**
+         * @brief Returns true if the occupied slot, whose hash matches, holds value.
+         *
+         * With SmallKeySlots, a short key is settled by the copy in the slot without reading the node. Otherwise,
+         * and for keys that are too long for the slot, KeyEqual compares the node's value.
+         */
+        template <typename K>
+        static bool keyMatches(const Slot &slot, const InterningNode *node, const K &value)
+        {
+            if constexpr (slotKeyChars() > 0)
+            {
+                const typename SlotKey::Match match = slot.matchKey(StringView(value));
+                if (match != SlotKey::Match::Unknown)
+                {
+                    return match == SlotKey::Match::Yes;
+                }
+            }
+            return KeyEqual{}(node->value, value);
+        }
+
+        /**
+         * @brief Inserts a new object into the intern pool and returns a pointer to the interned object.
+         *
+         * The node is only allocated once the probe has established that no other thread inserted the value first,
+         * and only then is value forwarded into it; if another thread won the race, value is left untouched.
+         *
+         * If the table has not been replaced since the lock-free probe and the empty slot that ended it is still
+         * empty, no entry for value can have appeared on its probe sequence: occupied slots only ever turn into
+         * tombstones, and tombstones are not reused. The node is then written to that slot directly; otherwise
+         * the probe is retried under the lock.
+         *
+         * @param hash The hash of value.
+         * @param value The value to insert; either a T or a transparent key the new T is constructed from.
+         * @param probeEnd Where the preceding lock-free probe stopped.
+         * @return InterningNode* The node holding the interned object.
+         */
+        template <typename K>
+        InterningNode *insertNew(HashedValue hash, K &&value, const ProbeEnd &probeEnd)
+        {
+            std::unique_lock lock(m_mutex);
+            Table *table = m_table.load(std::memory_order_relaxed);
+            if (m_deferred && table && overloaded(m_used + 1, table->capacity) && reconcileLocked())
+            {
+                // Dead entries are only found here; erasing them may let the rehash below keep the size.
+                table = m_table.load(std::memory_order_relaxed);
+            }
+            if (!table || overloaded(m_used + 1, table->capacity))
+            {
+                // Grow only when live entries fill the table; otherwise rehashing at the same size drops the tombstones.
+                const std::size_t capacity = table ? table->capacity : 0;
+                table = rehash(fitCapacity(m_size + 1) > capacity ? std::max(capacity * 2, kMinCapacity) : capacity);
+            }
+
+            std::size_t i = slotIndex(*table, hash);
+            if (table == probeEnd.table && probeEnd.emptySlot != kNoSlot &&
+                table->slots[probeEnd.emptySlot].node.load(std::memory_order_relaxed) == nullptr)
+            {
+                i = probeEnd.emptySlot;
+            }
+            for (;; i = (i + 1) & (table->capacity - 1))
+            {
+                Slot &slot = table->slots[i];
+                InterningNode *node = slot.node.load(std::memory_order_relaxed);
+                if (node == nullptr)
+                {
+                    break;
+                }
+                if (node != tombstone() && slot.hash == hash && keyMatches(slot, node, value))
+                {
+                    // Nodes reach zero only under the exclusive lock, right before they are erased or buried.
+                    if (isZombie(node))
+                    {
+                        unbury(node);
+                    }
+                    node->refCount.fetch_add(1, std::memory_order_relaxed);
+                    return node;
+                }
+            }
+
+            Slot &slot = table->slots[i];
+            InterningNode *node = newNode(hash, std::forward<K>(value));
+            const detail::ValueFootprint footprint = detail::footprintOf(node->value);
+            m_contentBytes += footprint.content;
+            m_inNodeBytes += footprint.inNode;
+            m_externalBytes += footprint.external;
+            slot.hash = hash;
+            if constexpr (slotKeyChars() > 0)
+            {
+                slot.setKey(StringView(node->value));
+            }
+            slot.node.store(node, std::memory_order_release);
+            ++m_size;
+            ++m_used;
+            return node;
+        }
+
+        /**
+         * @brief Builds a table of newCapacity slots holding every live node and publishes it to readers.
+         *
+         * Only the slot array is reallocated; nodes keep their addresses. The previous table is retired, since
+         * lock-free readers may still be probing it. The caller must hold m_mutex exclusively.
+         *
+         * @param newCapacity The new number of slots. Must be a power of two.
+         * @return Table* The newly published table.
+         */
+        Table *rehash(std::size_t newCapacity)
+        {
+            Table *oldTable = m_table.load(std::memory_order_relaxed);
+            Table *newTable = allocateTable(newCapacity);
+            if (oldTable)
+            {
+                for (std::size_t i = 0; i < oldTable->capacity; ++i)
+                {
+                    const Slot &slot = oldTable->slots[i];
+                    InterningNode *node = slot.node.load(std::memory_order_relaxed);
+                    if (isOccupied(node))
+                    {
+                        std::size_t j = slotIndex(*newTable, slot.hash);
+                        while (newTable->slots[j].node.load(std::memory_order_relaxed) != nullptr)
+                        {
+                            j = (j + 1) & (newCapacity - 1);
+                        }
+                        newTable->slots[j].hash = slot.hash;
+                        static_cast<SlotKey &>(newTable->slots[j]) = slot;
+                        newTable->slots[j].node.store(node, std::memory_order_relaxed);
+                    }
+                }
+            }
+            m_used = m_size;
+
+            m_table.store(newTable, std::memory_order_release);
+            if (oldTable)
+            {
+                dropTable(oldTable);
+            }
+            return newTable;
+        }
+
+        /**
+         * @brief Disposes of a table that is no longer published: retired, or kept until destruction in an immortal pool.
+         */
+        void dropTable(Table *table)
+        {
+            if (m_immortal)
+            {
+                m_keptTables.push_back(table);
+            }
+            else
+            {
+                retire(table, &deleteTable);
+            }
+        }
+
+        /**
+         * @brief Hands unlinked memory over to epoch-based reclamation. The caller must hold m_mutex exclusively.
+         *
+         * @param ptr The memory to reclaim once no reader can reach it anymore.
+         * @param reclaim The function that frees ptr.
+         */
+        void retire(void *ptr, void (*reclaim)(Internify &, void *))
+        {
+            m_retired.push_back({ptr, reclaim, detail::EpochDomain::instance().retireEpoch()});
+            if (m_retired.size() >= m_reclaimAt)
+            {
+                reclaimRetired();
+            }
+        }
+
+        /**
+         * @brief Frees the retired memory that no reader can reach anymore. The caller must hold m_mutex exclusively.
+         */
+        void reclaimRetired()
+        {
+            const std::uint64_t current = detail::EpochDomain::instance().tryAdvance();
+            auto unsafe = std::partition(m_retired.begin(), m_retired.end(), [current](const Retired &retired)
+                                         { return !detail::EpochDomain::isSafe(retired.epoch, current); });
+            for (auto it = unsafe; it != m_retired.end(); ++it)
+            {
+                it->reclaim(*this, it->ptr);
+            }
+            m_retired.erase(unsafe, m_retired.end());
+            m_reclaimAt = m_retired.size() + kReclaimBatch;
+        }
+
+        /**
+         * @brief Takes a reference on node unless its count already dropped to zero.
+         *
+         * @param node The node found by a lock-free probe.
+         * @return true If a reference was taken.
+         */
+        static bool tryAcquire(InterningNode *node)
+        {
+            int count = node->refCount.load(std::memory_order_relaxed);
+            while (count > 0)
+            {
+                if (node->refCount.compare_exchange_weak(count, count + 1, std::memory_order_relaxed))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /**
+         * @brief Maps a hash to its home slot.
+         *
+         * Fibonacci hashing keeps the top bits of the scrambled hash, so weak hash functions such as the identity
+         * hash of integers still spread over the whole table.
+         *
+         * @param table The table being probed.
+         * @param hash The hash to map.
+         * @return std::size_t The index of the first slot to probe.
+         */
+        static std::size_t slotIndex(const Table &table, HashedValue hash)
+        {
+            return static_cast<std::size_t>((static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> table.shift);
+        }
+
+        static InterningNode *tombstone()
+        {
+            return reinterpret_cast<InterningNode *>(alignof(InterningNode));
+        }
+
+        static bool isOccupied(const InterningNode *node)
+        {
+            return node != nullptr && node != tombstone();
+        }
+
+        /**
+         * @brief Allocates and constructs the node of a new entry. The caller must hold m_mutex exclusively.
+         *
+         * Nodes come from the slab pool, except with an inline-payload Storage, whose nodes vary in size and are
+         * allocated together with their payload from the Storage's node resource.
+         */
+        template <typename K>
+        InterningNode *newNode(HashedValue hash, K &&value)
+        {
+            if constexpr (detail::has_inline_payload<Storage>::value)
+            {
+                const std::size_t bytes = sizeof(InterningNode) + m_storage.payload_size(value);
+                void *memory = m_storage.node_resource()->allocate(bytes, alignof(InterningNode));
+                try
+                {
+                    void *payload = static_cast<char *>(memory) + sizeof(InterningNode);
+                    return ::new (memory) InterningNode(hash, m_resource, m_storage.store(value, payload));
+                }
+                catch (...)
+                {
+                    m_storage.node_resource()->deallocate(memory, bytes, alignof(InterningNode));
+                    throw;
+                }
+            }
+            else
+            {
+                void *memory = m_nodes.allocate();
+                try
+                {
+                    return ::new (memory) InterningNode(hash, m_resource, m_storage.store(std::forward<K>(value)));
+                }
+                catch (...)
+                {
+                    m_nodes.deallocate(memory);
+                    throw;
+                }
+            }
+        }
+
+        /**
+         * @brief Destroys a node allocated by newNode() and frees its memory. The caller must hold m_mutex exclusively.
+         */
+        void freeNode(InterningNode *node) noexcept
+        {
+            m_externalBytes -= detail::footprintOf(node->value).external;
+            m_storage.discard(node->value);
+            if constexpr (detail::has_inline_payload<Storage>::value)
+            {
+                const std::size_t bytes = sizeof(InterningNode) + m_storage.payload_size(node->value);
+                node->~InterningNode();
+                m_storage.node_resource()->deallocate(node, bytes, alignof(InterningNode));
+            }
+            else
+            {
+                node->~InterningNode();
+                m_nodes.deallocate(node);
+            }
+        }
+
+        static void deleteNode(Internify &self, void *node) { self.freeNode(static_cast<InterningNode *>(node)); }
+
+        static void deleteTable(Internify &self, void *table) { self.freeTable(static_cast<Table *>(table)); }
+
+        /**
+         * @brief Allocates a table of capacity empty slots from m_counted, header and slots in one block.
+         */
+        Table *allocateTable(std::size_t capacity)
+        {
+            void *memory = m_counted.allocate(kSlotsOffset + capacity * sizeof(Slot), kTableAlignment);
+            m_tableBytes += kSlotsOffset + capacity * sizeof(Slot);
+            Slot *slots = reinterpret_cast<Slot *>(static_cast<char *>(memory) + kSlotsOffset);
+            std::uninitialized_default_construct_n(slots, capacity);
+            return ::new (memory) Table(capacity, slots);
+        }
+
+        void freeTable(Table *table) noexcept
+        {
+            const std::size_t capacity = table->capacity;
+            std::destroy_n(table->slots, capacity);
+            table->~Table();
+            m_counted.deallocate(table, kSlotsOffset + capacity * sizeof(Slot), kTableAlignment);
+            m_tableBytes -= kSlotsOffset + capacity * sizeof(Slot);
+        }
+
+        /**
+         * @brief Constructs the value of a new node from key, passing resource along if the value uses a std::pmr allocator.
+         */
+        template <typename K>
+        static value_type makeValue(std::pmr::memory_resource *resource, K &&key)
+        {
+            using Allocator = std::pmr::polymorphic_allocator<std::byte>;
+            if constexpr (!std::uses_allocator_v<value_type, Allocator>)
+            {
+                return value_type(std::forward<K>(key));
+            }
+            else if constexpr (std::is_constructible_v<value_type, std::allocator_arg_t, Allocator, K>)
+            {
+                return value_type(std::allocator_arg, Allocator(resource), std::forward<K>(key));
+            }
+            else
+            {
+                return value_type(std::forward<K>(key), Allocator(resource));
+            }
+        }
+
+        /**
+         * @brief Constructs the Storage, handing it resource if it accepts one.
+         */
+        static Storage makeStorage(std::pmr::memory_resource *resource)
+        {
+            if constexpr (std::is_constructible_v<Storage, std::pmr::memory_resource *>)
+            {
+                return Storage(resource);
+            }
+            else
+            {
+                return Storage();
+            }
+        }
+
+        /**
+         * @brief Hashes the given value using the hash function provided in the template parameter.
+         *
+         * @param value The value to hash; either a T or a transparent key.
+         * @return HashedValue The hashed value.
+         */
+        template <typename K>
+        HashedValue hashValue(const K &value) const
+        {
+            return HashFunc{}(value);
+        }
+
+        alignas(detail::kCacheLineSize) std::atomic<Table *> m_table{nullptr}; // read by every lookup, kept apart from writer state
+        const std::uint64_t m_id = detail::nextPoolId();                       // tells this pool's front cache entries apart
+        alignas(detail::kCacheLineSize) mutable std::array<std::atomic<std::uint64_t>, kEraseStripes> m_eraseGenerations{}; // see eraseGeneration()
+        alignas(detail::kCacheLineSize) mutable std::shared_mutex m_mutex;
+        std::pmr::memory_resource *const m_resource; // provides values that use a std::pmr allocator
+        detail::CountingResource m_counted;          // m_resource, counted; provides tables, nodes and Storage
+        detail::NodePool<InterningNode> m_nodes;     // only used under the exclusive lock
+        std::size_t m_size = 0;         // live entries
+        std::size_t m_used = 0;         // live entries plus tombstones in the current table
+        std::vector<Retired> m_retired; // unlinked nodes and tables awaiting reclamation
+        std::size_t m_reclaimAt = kReclaimBatch;
+        Storage m_storage; // only used under the exclusive lock
+        detail::SymbolIndex<InterningNode> m_symbols;
+        bool m_immortal = false;           // set for the pool backing an ImmortalInternify
+        bool m_autoShrink = false;         // see set_auto_shrink()
+        bool m_deferred = false;           // set by the DeferredRefCounts constructor
+        std::size_t m_zombieBudget = 0;       // see set_zombie_budget()
+        std::vector<InterningNode *> m_zombies; // released nodes still in the table; each one's count encodes its index
+        std::size_t m_zombieCursor = 0;       // next zombie to evict
+        std::size_t m_tableBytes = 0;      // the rest is accounting for memory_stats(), updated under the exclusive lock
+        std::size_t m_contentBytes = 0;
+        std::size_t m_inNodeBytes = 0;
+        std::size_t m_externalBytes = 0;
+        std::vector<Table *> m_keptTables; // replaced tables of an immortal pool, which readers probe without an epoch
+    };
+
+    /**
+     * @brief The ShardedInternify class template splits the intern pool into independent shards.
+     *
+     * Each shard is a complete Internify instance with its own table and its own lock. The hash of a value
+     * selects the shard, so inserts and releases of values that land in different shards proceed in parallel
+     * instead of serializing on a single mutex.
+     *
+     * @tparam T The type of objects to be interned. T must be copyable.
+     * @tparam HashFunc A hash function object that takes an object of type T and returns an unsigned integer. Defaults to scc::Hash<T>.
+     * @tparam KeyEqual An equality predicate for objects of type T. Defaults to std::equal_to<>.
+     * @tparam ShardCount The number of shards. Must be a power of two. Defaults to 16.
+     * @tparam Storage The storage policy of every shard. Defaults to scc::ValueStorage<T>.
+     */
+    template <typename T, typename HashFunc = Hash<T>, typename KeyEqual = std::equal_to<>, std::size_t ShardCount = 16,
+              typename Storage = ValueStorage<T>>
+    class ShardedInternify
+    {
+        static_assert(ShardCount > 0 && (ShardCount & (ShardCount - 1)) == 0, "ShardCount must be a power of two");
+
+        template <typename K>
+        using EnableIfTransparent = detail::enable_if_heterogeneous_t<HashFunc, KeyEqual, T, K>;
+
+        using StringView = typename detail::string_view_of<T>::type;
+
+    public:
+        using Shard = Internify<T, HashFunc, KeyEqual, Storage>;
+        using value_type = typename Shard::value_type;
+        using InternedPtr = typename Shard::InternedPtr;
+        using HashedValue = typename Shard::HashedValue;
+
+        ShardedInternify()
+            : ShardedInternify(std::pmr::get_default_resource()) {}
+
+        /**
+         * @brief Constructs an empty sharded pool whose shards all allocate from resource. See Internify::Internify(std::pmr::memory_resource *).
+         *
+         * @param resource The memory resource to allocate from. It must outlive the pool.
+         */
+        explicit ShardedInternify(std::pmr::memory_resource *resource)
+            : m_shards(makeShards(std::make_index_sequence<ShardCount>{}, resource)) {}
+
+        /**
+         * @brief Constructs an empty sharded pool with deferred reference counting. See Internify::Internify(DeferredRefCounts, std::pmr::memory_resource *).
+         *
+         * @param tag deferred_refcounts.
+         * @param resource The memory resource to allocate from. It must outlive the pool.
+         */
+        explicit ShardedInternify(DeferredRefCounts tag, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : m_shards(makeShards(std::make_index_sequence<ShardCount>{}, tag, resource)) {}
+
+        ~ShardedInternify() = default;
+
+        ShardedInternify(const ShardedInternify &) = delete;
+        ShardedInternify &operator=(const ShardedInternify &) = delete;
+
+        /**
+         * @brief Interns the given value in the shard selected by its hash.
+         *
+         * The value is hashed once; the same hash selects the shard and is handed to it.
+         *
+         * @param value The value to be interned.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        [[nodiscard]] InternedPtr internify(const T &value)
+        {
+            return internify_prehashed(HashFunc{}(value), value);
+        }
+
+        /**
+         * @brief Interns the given value, moving it into its shard on a miss. See Internify::internify(T &&).
+         *
+         * @param value The value to be interned.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        [[nodiscard]] InternedPtr internify(T &&value)
+        {
+            const HashedValue hash = HashFunc{}(value);
+            return internify_prehashed(hash, std::move(value));
+        }
+
+        /**
+         * @brief Constructs a T from args and interns it. See Internify::internify_emplace().
+         *
+         * @param args The arguments to construct the T from.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        template <typename... Args>
+        [[nodiscard]] InternedPtr internify_emplace(Args &&...args)
+        {
+            return internify(T(std::forward<Args>(args)...));
+        }
+
+        /**
+         * @brief Interns the value equal to key without constructing a T on a hit. See Internify::internify(const K &).
+         *
+         * @param key A key that hashes and compares like the T constructed from it, e.g. a std::string_view.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        [[nodiscard]] InternedPtr internify(const K &key)
+        {
+            return internify_prehashed(HashFunc{}(key), key);
+        }
+
+        /**
+         * @brief Interns the string made of the size characters at data, which need not be null-terminated.
+         *
+         * @param data Pointer to the first character.
+         * @param size The number of characters.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        template <typename View = StringView, typename = EnableIfTransparent<View>>
+        [[nodiscard]] InternedPtr internify(const typename View::value_type *data, std::size_t size)
+        {
+            return internify(View(data, size));
+        }
+
+        /**
+         * @brief Interns the given value using a precomputed hash. See Internify::internify_prehashed().
+         *
+         * @param hash The hash of value; it also selects the shard.
+         * @param value The value to be interned.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        [[nodiscard]] InternedPtr internify_prehashed(HashedValue hash, const T &value)
+        {
+            return shardFor(hash).internify_prehashed(hash, value);
+        }
+
+        /**
+         * @brief Interns the given value using a precomputed hash, moving it into its shard on a miss.
+         *
+         * @param hash The hash of value; it also selects the shard.
+         * @param value The value to be interned.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        [[nodiscard]] InternedPtr internify_prehashed(HashedValue hash, T &&value)
+        {
+            return shardFor(hash).internify_prehashed(hash, std::move(value));
+        }
+
+        /**
+         * @brief Interns the value equal to key using a precomputed hash. Only available for transparent pools.
+         *
+         * @param hash The hash of key; it also selects the shard.
+         * @param key A key that compares like the T constructed from it, e.g. a std::string_view.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        [[nodiscard]] InternedPtr internify_prehashed(HashedValue hash, const K &key)
+        {
+            return shardFor(hash).internify_prehashed(hash, key);
+        }
+
+        /**
+         * @brief Finds the interned object corresponding to value without creating a new entry.
+         *
+         * @param value The value to find in the intern pool.
+         * @return InternedPtr A smart pointer to the interned object, or an invalid InternedPtr if the object is not found.
+         */
+        [[nodiscard]] InternedPtr find(const T &value) const
+        {
+            return find_prehashed(HashFunc{}(value), value);
+        }
+
+        /**
+         * @brief Finds the interned object equal to key without constructing a T. See Internify::find(const K &).
+         *
+         * @param key A key that hashes and compares like the T constructed from it, e.g. a std::string_view.
+         * @return InternedPtr A smart pointer to the interned object, or an invalid InternedPtr if the object is not found.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        [[nodiscard]] InternedPtr find(const K &key) const
+        {
+            return find_prehashed(HashFunc{}(key), key);
+        }
+
+        /**
+         * @brief Finds the interned object corresponding to value using a precomputed hash.
+         *
+         * @param hash The hash of value; it also selects the shard.
+         * @param value The value to find in the intern pool.
+         * @return InternedPtr A smart pointer to the interned object, or an invalid InternedPtr if the object is not found.
+         */
+        [[nodiscard]] InternedPtr find_prehashed(HashedValue hash, const T &value) const
+        {
+            return shardFor(hash).find_prehashed(hash, value);
+        }
+
+        /**
+         * @brief Finds the interned object equal to key using a precomputed hash. Only available for transparent pools.
+         *
+         * @param hash The hash of key; it also selects the shard.
+         * @param key A key that compares like the T constructed from it, e.g. a std::string_view.
+         * @return InternedPtr A smart pointer to the interned object, or an invalid InternedPtr if the object is not found.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        [[nodiscard]] InternedPtr find_prehashed(HashedValue hash, const K &key) const
+        {
+            return shardFor(hash).find_prehashed(hash, key);
+        }
+
+        /**
+         * @brief Calls fn with the interned object equal to value, without taking a reference. See Internify::with_interned().
+         *
+         * @param value The value to look up.
+         * @param fn A callable taking a const value_type &.
+         * @return true If value was interned and fn was called.
+         */
+        template <typename Fn>
+        bool with_interned(const T &value, Fn &&fn) const
+        {
+            const HashedValue hash = HashFunc{}(value);
+            return shardFor(hash).withInterned(hash, value, std::forward<Fn>(fn));
+        }
+
+        /**
+         * @brief Calls fn with the interned object equal to key, without taking a reference. Only available for transparent pools.
+         *
+         * @param key A key that hashes and compares like the T constructed from it, e.g. a std::string_view.
+         * @param fn A callable taking a const value_type &.
+         * @return true If key was interned and fn was called.
+         */
+        template <typename K, typename Fn, typename = EnableIfTransparent<K>>
+        bool with_interned(const K &key, Fn &&fn) const
+        {
+            const HashedValue hash = HashFunc{}(key);
+            return shardFor(hash).withInterned(hash, key, std::forward<Fn>(fn));
+        }
+
+        /**
+         * @brief Returns the interned object equal to value, borrowed for as long as guard lives. See Internify::borrow().
+         *
+         * @param guard The guard that keeps the object alive; created on the calling thread.
+         * @param value The value to look up.
+         * @return const value_type* The interned object, or nullptr if value is not interned.
+         */
+        const value_type *borrow(const ReadGuard &guard, const T &value) const
+        {
+            const HashedValue hash = HashFunc{}(value);
+            return shardFor(hash).borrowImpl(guard, hash, value);
+        }
+
+        /**
+         * @brief Returns the interned object equal to key, borrowed for as long as guard lives. Only available for transparent pools.
+         *
+         * @param guard The guard that keeps the object alive; created on the calling thread.
+         * @param key A key that hashes and compares like the T constructed from it, e.g. a std::string_view.
+         * @return const value_type* The interned object, or nullptr if key is not interned.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        const value_type *borrow(const ReadGuard &guard, const K &key) const
+        {
+            const HashedValue hash = HashFunc{}(key);
+            return shardFor(hash).borrowImpl(guard, hash, key);
+        }
+
+        /**
+         * @brief Interns the given value through the calling thread's front cache. See Internify::internify_cached().
+         *
+         * @param value The value to be interned.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        [[nodiscard]] InternedPtr internify_cached(const T &value)
+        {
+            const HashedValue hash = HashFunc{}(value);
+            return shardFor(hash).internifyCached(hash, value);
+        }
+
+        /**
+         * @brief Interns the value equal to key through the calling thread's front cache. Only available for transparent pools.
+         *
+         * @param key A key that hashes and compares like the T constructed from it, e.g. a std::string_view.
+         * @return InternedPtr A smart pointer to the interned object.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        [[nodiscard]] InternedPtr internify_cached(const K &key)
+        {
+            const HashedValue hash = HashFunc{}(key);
+            return shardFor(hash).internifyCached(hash, key);
+        }
+
+        /**
+         * @brief Returns the counters of the calling thread's front cache, which all shards share.
+         *
+         * @return FrontCacheStats The counters since the thread started or last called reset_front_cache_stats().
+         */
+        static FrontCacheStats front_cache_stats() { return Shard::front_cache_stats(); }
+
+        /**
+         * @brief Resets the calling thread's front cache counters.
+         */
+        static void reset_front_cache_stats() { Shard::reset_front_cache_stats(); }
+
+        /**
+         * @brief Interns every value in [first, last) in parallel and writes the results to out, in input order.
+         *
+         * Every value is hashed once, in parallel, and its index is partitioned by shard, keeping input order
+         * within each shard. The partitioned indices are then interned in chunks by the threads of the
+         * work-stealing pool (see Internify::intern_bulk()). A chunk holds the values of one or a few shards, so
+         * each thread mostly works in one shard at a time: hits scale with the threads even when they all fall
+         * into one hot shard, and misses mostly take different shard locks. Small batches stay on the calling
+         * thread.
+         *
+         * @param first The beginning of a random-access range of T or, for transparent pools, of keys.
+         * @param last The end of the range.
+         * @param out The beginning of a random-access range of at least last - first InternedPtr, which receive
+         *            handles, or SymbolId, which receive ids. If interning throws, some may already be assigned.
+         */
+        template <typename InputIt, typename OutputIt>
+        void intern_bulk(InputIt first, InputIt last, OutputIt out)
+        {
+            using Output = std::decay_t<decltype(*out)>;
+            static_assert(std::is_same_v<Output, InternedPtr> || std::is_same_v<Output, SymbolId>,
+                          "intern_bulk() writes InternedPtr or SymbolId");
+
+            const auto store = [&out, this](std::size_t index, std::size_t shard, InternedPtr &&ptr)
+            {
+                if constexpr (std::is_same_v<Output, SymbolId>)
+                {
+                    out[index] = toId(shard, std::move(ptr));
+                }
+                else
+                {
+                    out[index] = std::move(ptr);
+                }
+            };
+
+            const auto count = static_cast<std::size_t>(std::distance(first, last));
+            const std::size_t chunks = (count + detail::kBulkChunkSize - 1) / detail::kBulkChunkSize;
+            if (chunks <= 1)
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    const HashedValue hash = HashFunc{}(first[i]);
+                    store(i, shardIndex(hash), internify_prehashed(hash, first[i]));
+                }
+                return;
+            }
+
+            // Hash every value and count the values of each chunk that fall into each shard.
+            std::vector<HashedValue> hashes(count);
+            std::vector<std::size_t> cursors(ShardCount * chunks); // indexed [shard * chunks + chunk]
+            detail::forEachChunk(count, [&](std::size_t begin, std::size_t end)
+                                 {
+                                     const std::size_t chunk = begin / detail::kBulkChunkSize;
+                                     for (std::size_t i = begin; i < end; ++i)
+                                     {
+                                         hashes[i] = HashFunc{}(first[i]);
+                                         ++cursors[shardIndex(hashes[i]) * chunks + chunk];
+                                     } });
+
+            // Shard-major prefix sums turn the counts into where each chunk writes its values of each shard.
+            std::size_t total = 0;
+            for (std::size_t slot = 0; slot < cursors.size(); ++slot)
+            {
+                total += std::exchange(cursors[slot], total);
+            }
+
+            std::vector<std::size_t> order(count);
+            detail::forEachChunk(count, [&](std::size_t begin, std::size_t end)
+                                 {
+                                     const std::size_t chunk = begin / detail::kBulkChunkSize;
+                                     for (std::size_t i = begin; i < end; ++i)
+                                     {
+                                         order[cursors[shardIndex(hashes[i]) * chunks + chunk]++] = i;
+                                     } });
+
+            detail::forEachChunk(count, [&](std::size_t begin, std::size_t end)
+                                 {
+                                     for (std::size_t k = begin; k < end; ++k)
+                                     {
+                                         const std::size_t i = order[k];
+                                         const std::size_t shard = shardIndex(hashes[i]);
+                                         store(i, shard, m_shards[shard].shard.internify_prehashed(hashes[i], first[i]));
+                                     } });
+        }
+
+        /**
+         * @brief Interns the given value and returns its SymbolId. See Internify::internify_id().
+         *
+         * Ids are unique across the shards: the low bits name the shard and the rest is the shard's own id.
+         *
+         * @param value The value to be interned.
+         * @return SymbolId The id of the interned object.
+         */
+        [[nodiscard]] SymbolId internify_id(const T &value)
+        {
+            const HashedValue hash = HashFunc{}(value);
+            return toId(shardIndex(hash), internify_prehashed(hash, value));
+        }
+
+        /**
+         * @brief Interns the given value, moving it into its shard on a miss, and returns its SymbolId.
+         *
+         * @param value The value to be interned.
+         * @return SymbolId The id of the interned object.
+         */
+        [[nodiscard]] SymbolId internify_id(T &&value)
+        {
+            const HashedValue hash = HashFunc{}(value);
+            return toId(shardIndex(hash), internify_prehashed(hash, std::move(value)));
+        }
+
+        /**
+         * @brief Interns the value equal to key and returns its SymbolId. Only available for transparent pools.
+         *
+         * @param key A key that hashes and compares like the T constructed from it, e.g. a std::string_view.
+         * @return SymbolId The id of the interned object.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        [[nodiscard]] SymbolId internify_id(const K &key)
+        {
+            const HashedValue hash = HashFunc{}(key);
+            return toId(shardIndex(hash), internify_prehashed(hash, key));
+        }
+
+        /**
+         * @brief Turns a handle into the SymbolId of its object; the handle's reference passes to the id.
+         *
+         * @param ptr A handle obtained from this pool. It is left invalid.
+         * @return SymbolId The id of the interned object, or kNoSymbol if ptr is invalid.
+         */
+        [[nodiscard]] SymbolId to_id(InternedPtr &&ptr)
+        {
+            return ptr ? toId(shardIndex(ptr.hash()), std::move(ptr)) : kNoSymbol;
+        }
+
+        /**
+         * @brief Returns the interned object named by id. Never takes a lock.
+         *
+         * @param id An id that currently owns a reference in this pool.
+         * @return const value_type& Reference to the interned object.
+         */
+        const value_type &resolve(SymbolId id) const
+        {
+            return shardOf(id).resolve(id >> kShardBits);
+        }
+
+        /**
+         * @brief Adds a reference to the object named by id.
+         *
+         * @param id An id that currently owns a reference in this pool.
+         */
+        void retain(SymbolId id)
+        {
+            shardOf(id).retain(id >> kShardBits);
+        }
+
+        /**
+         * @brief Drops one reference owned by id.
+         *
+         * @param id An id that currently owns a reference in this pool.
+         */
+        void release(SymbolId id)
+        {
+            shardOf(id).release(id >> kShardBits);
+        }
+
+        /**
+         * @brief Returns the number of unique interned objects across all shards.
+         *
+         * The shards are visited one after another, so the result is only a snapshot when other threads are
+         * interning or releasing concurrently.
+         *
+         * @return std::size_t The number of interned objects.
+         */
+        std::size_t size() const
+        {
+            std::size_t total = 0;
+            for (const auto &padded : m_shards)
+            {
+                total += padded.shard.size();
+            }
+            return total;
+        }
+
+        /**
+         * @brief Returns the memory figures of all shards added up. See Internify::memory_stats().
+         *
+         * @return MemoryStats The current figures.
+         */
+        MemoryStats memory_stats() const
+        {
+            MemoryStats stats;
+            for (const auto &padded : m_shards)
+            {
+                stats += padded.shard.memory_stats();
+            }
+            return stats;
+        }
+
+        /**
+         * @brief Calls fn with every interned object, shard by shard. See Internify::for_each().
+         *
+         * @param fn A callable taking a const value_type &.
+         */
+        template <typename Fn>
+        void for_each(Fn &&fn) const
+        {
+            for (const auto &padded : m_shards)
+            {
+                padded.shard.for_each(fn);
+            }
+        }
+
+        /**
+         * @brief Sets the zombie budget of the pool, split evenly over the shards. See Internify::set_zombie_budget().
+         *
+         * @param budget The maximum number of zombies in the whole pool, rounded up to a multiple of ShardCount.
+         */
+        void set_zombie_budget(std::size_t budget)
+        {
+            for (auto &padded : m_shards)
+            {
+                padded.shard.set_zombie_budget((budget + ShardCount - 1) / ShardCount);
+            }
+        }
+
+        /**
+         * @brief Erases every zombie of every shard. See Internify::sweep_zombies().
+         *
+         * @return std::size_t The number of zombies erased.
+         */
+        std::size_t sweep_zombies()
+        {
+            std::size_t erased = 0;
+            for (auto &padded : m_shards)
+            {
+                erased += padded.shard.sweep_zombies();
+            }
+            return erased;
+        }
+
+        /**
+         * @brief Reconciles every shard. See Internify::reconcile().
+         *
+         * @return std::size_t The number of entries erased.
+         */
+        std::size_t reconcile()
+        {
+            std::size_t erased = 0;
+            for (auto &padded : m_shards)
+            {
+                erased += padded.shard.reconcile();
+            }
+            return erased;
+        }
+
+        /**
+         * @brief Shrinks the table of every shard. See Internify::shrink_to_fit().
+         */
+        void shrink_to_fit()
+        {
+            for (auto &padded : m_shards)
+            {
+                padded.shard.shrink_to_fit();
+            }
+        }
+
+        /**
+         * @brief Compacts every shard. See Internify::compact().
+         */
+        void compact()
+        {
+            for (auto &padded : m_shards)
+            {
+                padded.shard.compact();
+            }
+        }
+
+        /**
+         * @brief Enables or disables automatic shrinking in every shard. See Internify::set_auto_shrink().
+         *
+         * @param enabled Whether to shrink automatically.
+         */
+        void set_auto_shrink(bool enabled)
+        {
+            for (auto &padded : m_shards)
+            {
+                padded.shard.set_auto_shrink(enabled);
+            }
+        }
+
+        /**
+         * @brief Returns the number of shards.
+         *
+         * @return std::size_t The number of shards.
+         */
+        static constexpr std::size_t shard_count() { return ShardCount; }
+
+    private:
+        /**
+         * @brief Keeps every shard, and therefore every shard mutex, on its own cache line.
+         */
+        struct alignas(detail::kCacheLineSize) PaddedShard
+        {
+            Shard shard;
+        };
+
+        template <std::size_t, typename... Args>
+        static PaddedShard makeShard(Args... args)
+        {
+            return PaddedShard{Shard(args...)};
+        }
+
+        template <std::size_t... Index, typename... Args>
+        static std::array<PaddedShard, ShardCount> makeShards(std::index_sequence<Index...>, Args... args)
+        {
+            return {{makeShard<Index>(args...)...}};
+        }
+
+        /**
+         * @brief Selects the shard responsible for the values with the given hash.
+         *
+         * The hash is scrambled with a different odd multiplier than the Fibonacci constant the shard's own table
+         * uses for bucketing, so all values of one shard do not crowd into the same region of that table.
+         *
+         * @param hash The hash of the value whose shard should be returned.
+         * @return std::size_t The shard index.
+         */
+        static std::size_t shardIndex(HashedValue hash)
+        {
+            if constexpr (ShardCount == 1)
+            {
+                return 0;
+            }
+            else
+            {
+                return static_cast<std::size_t>((static_cast<std::uint64_t>(hash) * 0xD6E8FEB86659FD93ull) >> (64 - kShardBits));
+            }
+        }
+
+        Shard &shardFor(HashedValue hash) { return m_shards[shardIndex(hash)].shard; }
+        const Shard &shardFor(HashedValue hash) const { return m_shards[shardIndex(hash)].shard; }
+
+        /**
+         * @brief Turns a handle from the given shard into a pool-wide SymbolId: the shard-local id, then the shard index in the low bits.
+         */
+        SymbolId toId(std::size_t shard, InternedPtr &&ptr)
+        {
+            const SymbolId local = m_shards[shard].shard.toId(std::move(ptr), ~SymbolId{0} >> kShardBits);
+            return local == kNoSymbol ? kNoSymbol : static_cast<SymbolId>((local << kShardBits) | shard);
+        }
+
+        Shard &shardOf(SymbolId id) { return m_shards[id & (ShardCount - 1)].shard; }
+        const Shard &shardOf(SymbolId id) const { return m_shards[id & (ShardCount - 1)].shard; }
+
+        static constexpr unsigned kShardBits = detail::bitWidth(ShardCount - 1);
+
+        std::array<PaddedShard, ShardCount> m_shards;
+    };
+
+    /**
+     * @brief The ImmortalInternify class template interns objects that stay in the pool until the pool is destroyed.
+     *
+     * Meant for symbol tables that never free their symbols. Since entries are never released, handles carry no
+     * reference: a Symbol is a trivially copyable pointer to the interned object, and copying or dropping one
+     * costs nothing. Hits probe the table without a lock, an epoch or any atomic read-modify-write; in exchange
+     * the tables replaced by rehashing are kept until destruction, which at most doubles the slot memory.
+     * Misses insert through the same path as Internify.
+     *
+     * @tparam T The type of objects to be interned. T must be copyable.
+     * @tparam HashFunc A hash function object that takes an object of type T and returns an unsigned integer. Defaults to scc::Hash<T>.
+     * @tparam KeyEqual An equality predicate for objects of type T. Defaults to std::equal_to<>.
+     * @tparam Storage The storage policy deciding how interned values are held. Defaults to scc::ValueStorage<T>.
+     */
+    template <typename T, typename HashFunc = Hash<T>, typename KeyEqual = std::equal_to<>, typename Storage = ValueStorage<T>>
+    class ImmortalInternify
+    {
+        using Pool = Internify<T, HashFunc, KeyEqual, Storage>;
+
+        template <typename K>
+        using EnableIfTransparent = detail::enable_if_heterogeneous_t<HashFunc, KeyEqual, T, K>;
+
+    public:
+        using value_type = typename Pool::value_type;
+        using HashedValue = typename Pool::HashedValue;
+
+        /**
+         * @brief A handle to an immortal interned object: a plain pointer, equal for equal values.
+         */
+        class Symbol
+        {
+        public:
+            Symbol() = default;
+
+            /**
+             * @brief Returns a pointer to the interned object.
+             *
+             * @return const value_type* Pointer to the interned object, or nullptr for an empty Symbol.
+             */
+            const value_type *get() const { return m_value; }
+
+            /**
+             * @brief Dereferences the handle to access the interned object.
+             *
+             * @return const value_type& Reference to the interned object.
+             * @note it is undefined behavior if this Symbol is empty.
+             */
+            const value_type &operator*() const { return *m_value; }
+
+            /**
+             * @brief Returns a pointer to the interned object.
+             *
+             * @return const value_type* Pointer to the interned object.
+             */
+            const value_type *operator->() const { return m_value; }
+
+            /**
+             * @brief Checks if the Symbol names an interned object.
+             *
+             * @return true If the Symbol is not empty, false otherwise.
+             */
+            explicit operator bool() const { return m_value != nullptr; }
+
+            bool operator==(Symbol other) const { return m_value == other.m_value; }
+            bool operator!=(Symbol other) const { return m_value != other.m_value; }
+
+        private:
+            friend class ImmortalInternify;
+
+            explicit Symbol(const value_type *value) : m_value(value) {}
+
+            const value_type *m_value = nullptr;
+        };
+
+        ImmortalInternify()
+            : ImmortalInternify(std::pmr::get_default_resource()) {}
+
+        /**
+         * @brief Constructs an empty immortal pool that allocates from resource. See Internify::Internify(std::pmr::memory_resource *).
+         *
+         * A std::pmr::monotonic_buffer_resource suits immortal pools well, since they never free entries.
+         *
+         * @param resource The memory resource to allocate from. It must outlive the pool.
+         */
+        explicit ImmortalInternify(std::pmr::memory_resource *resource)
+            : m_pool(detail::ImmortalTag{}, resource) {}
+
+        ImmortalInternify(const ImmortalInternify &) = delete;
+        ImmortalInternify &operator=(const ImmortalInternify &) = delete;
+
+        /**
+         * @brief Interns the given value for the lifetime of the pool.
+         *
+         * @param value The value to be interned.
+         * @return Symbol A handle to the interned object.
+         */
+        [[nodiscard]] Symbol internify(const T &value)
+        {
+            return internifyImpl(HashFunc{}(value), value);
+        }
+
+        /**
+         * @brief Interns the given value for the lifetime of the pool, moving it into the pool on a miss.
+         *
+         * @param value The value to be interned.
+         * @return Symbol A handle to the interned object.
+         */
+        [[nodiscard]] Symbol internify(T &&value)
+        {
+            const HashedValue hash = HashFunc{}(value);
+            return internifyImpl(hash, std::move(value));
+        }
+
+        /**
+         * @brief Interns the value equal to key for the lifetime of the pool. Only available for transparent pools.
+         *
+         * @param key A key that hashes and compares like the T constructed from it, e.g. a std::string_view.
+         * @return Symbol A handle to the interned object.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        [[nodiscard]] Symbol internify(const K &key)
+        {
+            return internifyImpl(HashFunc{}(key), key);
+        }
+
+        /**
+         * @brief Finds the interned object corresponding to value without creating a new entry.
+         *
+         * @param value The value to find in the intern pool.
+         * @return Symbol A handle to the interned object, or an empty Symbol if the object is not found.
+         */
+        [[nodiscard]] Symbol find(const T &value) const
+        {
+            return findImpl(HashFunc{}(value), value);
+        }
+
+        /**
+         * @brief Finds the interned object equal to key without constructing a T. Only available for transparent pools.
+         *
+         * @param key A key that hashes and compares like the T constructed from it, e.g. a std::string_view.
+         * @return Symbol A handle to the interned object, or an empty Symbol if the object is not found.
+         */
+        template <typename K, typename = EnableIfTransparent<K>>
+        [[nodiscard]] Symbol find(const K &key) const
+        {
+            return findImpl(HashFunc{}(key), key);
+        }
+
+        /**
+         * @brief Returns the number of unique interned objects.
+         *
+         * @return std::size_t The number of interned objects.
+         */
+        std::size_t size() const { return m_pool.size(); }
+
+        /**
+         * @brief Returns what the pool currently costs. See Internify::memory_stats().
+         *
+         * Symbols are not counted, so total_references equals live_entries.
+         *
+         * @return MemoryStats The current figures.
+         */
+        MemoryStats memory_stats() const { return m_pool.memory_stats(); }
+
+        /**
+         * @brief Calls fn with every interned object. See Internify::for_each().
+         *
+         * @param fn A callable taking a const value_type &.
+         */
+        template <typename Fn>
+        void for_each(Fn &&fn) const
+        {
+            m_pool.for_each(std::forward<Fn>(fn));
+        }
+
+    private:
+        template <typename K>
+        Symbol internifyImpl(HashedValue hash, K &&value)
+        {
+            if (const auto *node = m_pool.probe(hash, value))
+            {
+                return Symbol(&node->value);
+            }
+            // The reference taken by the insert is never dropped, so the entry lives as long as the pool.
+            typename Pool::InternedPtr ptr = m_pool.internifyImpl(hash, std::forward<K>(value));
+            return Symbol(&Pool::detach(ptr)->value);
+        }
+
+        template <typename K>
+        Symbol findImpl(HashedValue hash, const K &value) const
+        {
+            const auto *node = m_pool.probe(hash, value);
+            return Symbol(node ? &node->value : nullptr);
         }
 
-        std::unordered_map<HashedValue, std::unique_ptr<InterningNode>> m_interningMap;
-        mutable std::shared_mutex m_mutex;
+        Pool m_pool;
     };
 }
 
@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+#include <internify.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr int kBatch = 1 << 17;
+    constexpr int kDistinct = 1 << 14;
+
+    // A batch of kBatch values drawn from kDistinct keys, as when ingesting a column of repeated symbols.
+    const std::vector<std::string> &batch()
+    {
+        static const std::vector<std::string> values = []
+        {
+            std::vector<std::string> result;
+            result.reserve(kBatch);
+            for (int i = 0; i < kBatch; ++i)
+            {
+                result.push_back("bulk/key/" + std::to_string((i * 7919) % kDistinct));
+            }
+            return result;
+        }();
+        return values;
+    }
+
+    // Interns the batch into a fresh pool one value at a time.
+    template <typename Pool>
+    void BM_LoopIntern(benchmark::State &state)
+    {
+        const auto &input = batch();
+        std::vector<typename Pool::InternedPtr> handles(input.size());
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            auto pool = std::make_unique<Pool>();
+            state.ResumeTiming();
+
+            for (std::size_t i = 0; i < input.size(); ++i)
+            {
+                handles[i] = pool->internify(input[i]);
+            }
+
+            state.PauseTiming();
+            handles.assign(input.size(), {});
+            pool.reset();
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(state.iterations() * kBatch);
+    }
+
+    // Interns the batch into a fresh pool with one intern_bulk() call.
+    template <typename Pool>
+    void BM_BulkIntern(benchmark::State &state)
+    {
+        const auto &input = batch();
+        std::vector<typename Pool::InternedPtr> handles(input.size());
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            auto pool = std::make_unique<Pool>();
+            state.ResumeTiming();
+
+            pool->intern_bulk(input.begin(), input.end(), handles.begin());
+
+            state.PauseTiming();
+            handles.assign(input.size(), {});
+            pool.reset();
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(state.iterations() * kBatch);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_LoopIntern, scc::Internify<std::string>)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BulkIntern, scc::Internify<std::string>)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_LoopIntern, scc::ShardedInternify<std::string>)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BulkIntern, scc::ShardedInternify<std::string>)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+#include <internify.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::atomic<long> g_allocations{0};
+}
+
+// Counts every allocation of the process, so the benchmark can report how often churn reaches the global allocator.
+void *operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    const auto align = static_cast<std::size_t>(alignment);
+    if (void *memory = std::aligned_alloc(align, (size + align - 1) / align * align))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void *memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+
+namespace
+{
+    constexpr int kNumKeys = 64;
+
+    const std::vector<std::string> &keys()
+    {
+        static const std::vector<std::string> keys = []
+        {
+            std::vector<std::string> result;
+            for (int i = 0; i < kNumKeys; ++i)
+            {
+                // Longer than the SSO buffer, like the identifiers in profile/data.txt.
+                result.push_back("churning/identifier/number/" + std::to_string(i));
+            }
+            return result;
+        }();
+        return keys;
+    }
+
+    // The pattern of profile/data.txt: a handful of values whose last handle is dropped and which are
+    // interned again right after, so each iteration erases one entry and inserts it anew.
+    template <typename Pool>
+    void BM_ChurnReintern(benchmark::State &state)
+    {
+        Pool pool;
+        pool.set_zombie_budget(static_cast<std::size_t>(state.range(0)));
+        const auto &input = keys();
+        std::size_t i = 0;
+        const long before = g_allocations.load(std::memory_order_relaxed);
+        for (auto _ : state)
+        {
+            auto ptr = pool.internify(input[i++ & (kNumKeys - 1)]);
+            benchmark::DoNotOptimize(ptr.get());
+        }
+        const long allocations = g_allocations.load(std::memory_order_relaxed) - before;
+        state.SetItemsProcessed(state.iterations());
+        state.counters["allocs/op"] = static_cast<double>(allocations) / static_cast<double>(state.iterations());
+    }
+}
+
+// The argument is the zombie budget: 0 erases every released entry, kNumKeys keeps all of them for reuse.
+BENCHMARK_TEMPLATE(BM_ChurnReintern, scc::Internify<std::string>)->Arg(0)->Arg(kNumKeys);
+BENCHMARK_TEMPLATE(BM_ChurnReintern, scc::Internify<std::string, scc::Hash<std::string>, std::equal_to<>, scc::ArenaStringStorage<>>)->Arg(0)->Arg(kNumKeys);
+BENCHMARK_TEMPLATE(BM_ChurnReintern, scc::Internify<std::string, scc::Hash<std::string>, std::equal_to<>, scc::InlineStringStorage<>>)->Arg(0)->Arg(kNumKeys);
+
+BENCHMARK_MAIN();
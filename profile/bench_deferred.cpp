@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+#include <internify.hpp>
+
+#include <string>
+
+namespace
+{
+    constexpr int kMaxThreads = 8;
+
+    // Every thread copies and drops handles to the same popular entry. With immediate counting each copy and
+    // each drop is an atomic RMW on the entry's cache line; with deferred counting it stays in the thread's buffer.
+    template <bool Deferred>
+    void BM_HotHandleCopy(benchmark::State &state)
+    {
+        static scc::Internify<std::string> pool = Deferred ? scc::Internify<std::string>(scc::deferred_refcounts)
+                                                           : scc::Internify<std::string>();
+        static auto hot = pool.internify("content-type");
+        for (auto _ : state)
+        {
+            auto copy = hot;
+            benchmark::DoNotOptimize(copy.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Lock-free hits on the popular entry, which take and drop a reference each.
+    template <bool Deferred>
+    void BM_HotHit(benchmark::State &state)
+    {
+        static scc::Internify<std::string> pool = Deferred ? scc::Internify<std::string>(scc::deferred_refcounts)
+                                                           : scc::Internify<std::string>();
+        static auto hot = pool.internify("content-type");
+        for (auto _ : state)
+        {
+            auto ptr = pool.internify(std::string_view("content-type"));
+            benchmark::DoNotOptimize(ptr.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_HotHandleCopy, false)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_HotHandleCopy, true)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_HotHit, false)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_HotHit, true)->ThreadRange(1, kMaxThreads)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,137 @@
+#include <benchmark/benchmark.h>
+#include <internify.hpp>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr int kNumKeys = 200;
+    constexpr int kMaxThreads = 8;
+
+    // A few hundred header names, interned over and over as request handlers do.
+    const std::vector<std::string> &keys()
+    {
+        static const std::vector<std::string> keys = []
+        {
+            std::vector<std::string> result;
+            result.reserve(kNumKeys);
+            for (int i = 0; i < kNumKeys; ++i)
+            {
+                result.push_back("x-header-" + std::to_string(i));
+            }
+            return result;
+        }();
+        return keys;
+    }
+
+    using Pool = scc::Internify<std::string>;
+
+    Pool &pool()
+    {
+        static Pool pool;
+        static const std::vector<Pool::InternedPtr> pinned = []
+        {
+            std::vector<Pool::InternedPtr> result;
+            for (const auto &key : keys())
+            {
+                result.push_back(pool.internify(key));
+            }
+            return result;
+        }();
+        return pool;
+    }
+
+    // Hits through the lock-free table probe.
+    void BM_HeaderHit(benchmark::State &state)
+    {
+        Pool &headers = pool();
+        const auto &input = keys();
+        std::size_t i = static_cast<std::size_t>(state.thread_index()) * 31;
+        for (auto _ : state)
+        {
+            auto ptr = headers.internify(std::string_view(input[i++ % kNumKeys]));
+            benchmark::DoNotOptimize(ptr.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // The same hits through the thread's front cache.
+    void BM_HeaderHitCached(benchmark::State &state)
+    {
+        Pool &headers = pool();
+        const auto &input = keys();
+        Pool::reset_front_cache_stats();
+        std::size_t i = static_cast<std::size_t>(state.thread_index()) * 31;
+        for (auto _ : state)
+        {
+            auto ptr = headers.internify_cached(std::string_view(input[i++ % kNumKeys]));
+            benchmark::DoNotOptimize(ptr.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.counters["hit_rate"] = benchmark::Counter(Pool::front_cache_stats().hit_rate(), benchmark::Counter::kAvgThreads);
+    }
+
+    // The same hits while thread 0 keeps interning and dropping short-lived keys in the pool, so entries are
+    // erased all the time. Only the other threads' hits are counted.
+    template <bool Cached>
+    void BM_HeaderHitUnderChurn(benchmark::State &state)
+    {
+        Pool &headers = pool();
+        if (state.thread_index() == 0)
+        {
+            std::size_t i = 0;
+            for (auto _ : state)
+            {
+                auto transient = headers.internify("x-request-id-" + std::to_string(i++));
+                benchmark::DoNotOptimize(transient.get());
+            }
+            return;
+        }
+
+        const auto &input = keys();
+        Pool::reset_front_cache_stats();
+        std::size_t i = static_cast<std::size_t>(state.thread_index()) * 31;
+        for (auto _ : state)
+        {
+            auto ptr = Cached ? headers.internify_cached(std::string_view(input[i++ % kNumKeys]))
+                              : headers.internify(std::string_view(input[i++ % kNumKeys]));
+            benchmark::DoNotOptimize(ptr.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+        if constexpr (Cached)
+        {
+            state.counters["hit_rate"] = Pool::front_cache_stats().hit_rate() / (state.threads() - 1);
+        }
+    }
+
+    // Cached hits on one thread with a short-lived key interned and dropped after every state.range(0) hits, so
+    // the erase rate does not depend on how the scheduler interleaves threads.
+    void BM_HeaderHitCachedInterleavedErase(benchmark::State &state)
+    {
+        Pool &headers = pool();
+        const auto &input = keys();
+        const auto interval = static_cast<std::size_t>(state.range(0));
+        Pool::reset_front_cache_stats();
+        std::size_t i = 0;
+        for (auto _ : state)
+        {
+            auto ptr = headers.internify_cached(std::string_view(input[i % kNumKeys]));
+            benchmark::DoNotOptimize(ptr.get());
+            if (++i % interval == 0)
+            {
+                auto transient = headers.internify("x-request-id-" + std::to_string(i));
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.counters["hit_rate"] = Pool::front_cache_stats().hit_rate();
+    }
+}
+
+BENCHMARK(BM_HeaderHit)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK(BM_HeaderHitCached)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_HeaderHitUnderChurn, false)->ThreadRange(2, kMaxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_HeaderHitUnderChurn, true)->ThreadRange(2, kMaxThreads)->UseRealTime();
+BENCHMARK(BM_HeaderHitCachedInterleavedErase)->Arg(2)->Arg(50);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+#include <internify.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace
+{
+    // Returns the AnonHugePages figure of the process in bytes, or 0 where /proc is not available.
+    double anonHugePageBytes()
+    {
+        std::ifstream rollup("/proc/self/smaps_rollup");
+        std::string field;
+        while (rollup >> field)
+        {
+            if (field == "AnonHugePages:")
+            {
+                double kib = 0;
+                rollup >> kib;
+                return kib * 1024;
+            }
+        }
+        return 0;
+    }
+
+    // Random hits on a pool of state.range(0) integers. Past a few million entries, each lookup touches a
+    // table slot and a node on pages of their own, so the cost is dominated by TLB misses and page walks.
+    template <bool HugePages>
+    void BM_RandomHit(benchmark::State &state)
+    {
+        const auto count = static_cast<std::uint64_t>(state.range(0));
+        scc::HugePageResource hugePages;
+        auto pool = std::make_unique<scc::ImmortalInternify<std::uint64_t>>(
+            HugePages ? &hugePages : std::pmr::get_default_resource());
+        for (std::uint64_t i = 0; i < count; ++i)
+        {
+            (void)pool->internify(i);
+        }
+
+        std::uint64_t x = 0x9E3779B97F4A7C15ull;
+        for (auto _ : state)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            auto symbol = pool->find(x % count);
+            benchmark::DoNotOptimize(symbol.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.counters["huge_page_bytes"] = anonHugePageBytes();
+        pool.reset();
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_RandomHit, false)->RangeMultiplier(8)->Range(1 << 16, 1 << 22);
+BENCHMARK_TEMPLATE(BM_RandomHit, true)->RangeMultiplier(8)->Range(1 << 16, 1 << 22);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,124 @@
+#include <benchmark/benchmark.h>
+#include <internify.hpp>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr int kNumKeys = 1 << 12;
+    constexpr int kMaxThreads = 8;
+
+    const std::vector<std::string> &keys()
+    {
+        static const std::vector<std::string> keys = []
+        {
+            std::vector<std::string> result;
+            result.reserve(kNumKeys);
+            for (int i = 0; i < kNumKeys; ++i)
+            {
+                result.push_back("symbol/" + std::to_string(i));
+            }
+            return result;
+        }();
+        return keys;
+    }
+
+    // Hits on a refcounted pool: every lookup takes a reference and every handle destruction drops it.
+    void BM_RefcountedHit(benchmark::State &state)
+    {
+        static scc::Internify<std::string> pool;
+        static std::vector<scc::Internify<std::string>::InternedPtr> pinned;
+        if (state.thread_index() == 0 && pinned.empty())
+        {
+            for (const auto &key : keys())
+            {
+                pinned.push_back(pool.internify(key));
+            }
+        }
+        const auto &input = keys();
+        std::size_t i = static_cast<std::size_t>(state.thread_index()) * 7919;
+        for (auto _ : state)
+        {
+            auto ptr = pool.internify(input[i++ & (kNumKeys - 1)]);
+            benchmark::DoNotOptimize(ptr.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Hits on an immortal pool: a plain probe, no reference to take or drop.
+    void BM_ImmortalHit(benchmark::State &state)
+    {
+        static scc::ImmortalInternify<std::string> pool;
+        if (state.thread_index() == 0 && pool.size() == 0)
+        {
+            for (const auto &key : keys())
+            {
+                (void)pool.internify(key);
+            }
+        }
+        const auto &input = keys();
+        std::size_t i = static_cast<std::size_t>(state.thread_index()) * 7919;
+        for (auto _ : state)
+        {
+            auto symbol = pool.internify(input[i++ & (kNumKeys - 1)]);
+            benchmark::DoNotOptimize(symbol.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Borrowed hits on a refcounted pool: the lookup runs in an epoch and takes no reference.
+    void BM_BorrowedHit(benchmark::State &state)
+    {
+        static scc::Internify<std::string> pool;
+        static std::vector<scc::Internify<std::string>::InternedPtr> pinned;
+        if (state.thread_index() == 0 && pinned.empty())
+        {
+            for (const auto &key : keys())
+            {
+                pinned.push_back(pool.internify(key));
+            }
+        }
+        const auto &input = keys();
+        std::size_t i = static_cast<std::size_t>(state.thread_index()) * 7919;
+        for (auto _ : state)
+        {
+            pool.with_interned(input[i++ & (kNumKeys - 1)], [](const std::string &value)
+                               { benchmark::DoNotOptimize(value.size()); });
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Copying handles, as symbol tables do when building ASTs: a refcount increment and decrement per copy.
+    void BM_RefcountedCopy(benchmark::State &state)
+    {
+        static scc::Internify<std::string> pool;
+        static auto handle = pool.internify("copied");
+        for (auto _ : state)
+        {
+            auto copy = handle;
+            benchmark::DoNotOptimize(copy.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void BM_ImmortalCopy(benchmark::State &state)
+    {
+        static scc::ImmortalInternify<std::string> pool;
+        static auto symbol = pool.internify("copied");
+        for (auto _ : state)
+        {
+            auto copy = symbol;
+            benchmark::DoNotOptimize(copy.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK(BM_RefcountedHit)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK(BM_ImmortalHit)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK(BM_BorrowedHit)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK(BM_RefcountedCopy)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK(BM_ImmortalCopy)->ThreadRange(1, kMaxThreads)->UseRealTime();
+
+BENCHMARK_MAIN();
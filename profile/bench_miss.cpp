@@ -0,0 +1,136 @@
+#include <benchmark/benchmark.h>
+#include <internify.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr int kBatch = 1 << 16;
+    constexpr int kMaxLoadEntries = 49152; // 3/4 of 65536 slots
+
+    std::atomic<long> g_hashCalls{0};
+
+    struct CountingHash
+    {
+        std::size_t operator()(const std::string &value) const
+        {
+            g_hashCalls.fetch_add(1, std::memory_order_relaxed);
+            return std::hash<std::string>{}(value);
+        }
+    };
+
+    using Pool = scc::Internify<std::string, CountingHash>;
+
+    const std::vector<std::string> &keys()
+    {
+        static const std::vector<std::string> keys = []
+        {
+            std::vector<std::string> result;
+            result.reserve(kBatch);
+            for (int i = 0; i < kBatch; ++i)
+            {
+                result.push_back("miss/key/" + std::to_string(i));
+            }
+            return result;
+        }();
+        return keys;
+    }
+
+    // Interns a batch of keys that are all new to the pool; every call is a miss.
+    template <typename InternFn>
+    void runMisses(benchmark::State &state, InternFn intern)
+    {
+        const auto &input = keys();
+        std::vector<Pool::InternedPtr> handles;
+        handles.reserve(kBatch);
+        long hashCalls = 0;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            handles.clear();
+            auto pool = std::make_unique<Pool>();
+            state.ResumeTiming();
+
+            const long hashCallsBefore = g_hashCalls.load(std::memory_order_relaxed);
+            for (const auto &key : input)
+            {
+                handles.push_back(intern(*pool, key));
+            }
+            hashCalls += g_hashCalls.load(std::memory_order_relaxed) - hashCallsBefore;
+
+            state.PauseTiming();
+            handles.clear();
+            pool.reset();
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(state.iterations() * kBatch);
+        state.counters["hashes/op"] = static_cast<double>(hashCalls) / static_cast<double>(state.iterations() * kBatch);
+    }
+
+    // Single probe: one hash, an optimistic lock-free probe, then a commit at the slot that probe ended on.
+    void BM_MissSingleProbe(benchmark::State &state)
+    {
+        runMisses(state, [](Pool &pool, const std::string &key)
+                  { return pool.internify(key); });
+    }
+
+    // The previous find-then-insert protocol, reproduced through the public API: the value is hashed and
+    // probed once by find() and again by the insertion.
+    void BM_MissFindThenInsert(benchmark::State &state)
+    {
+        runMisses(state, [](Pool &pool, const std::string &key)
+                  {
+                      if (auto existing = pool.find(key))
+                      {
+                          return existing;
+                      }
+                      return pool.internify(key); });
+    }
+
+    // find() of absent keys in a pool of state.range(0) entries, which land in a table of 65536 slots. Each miss
+    // scans to the next empty slot, so its cost tracks the load: 32768 entries fill the table to 1/2 and 49152 to
+    // 3/4, the most it holds. The benchmark checks that one more entry makes the table grow.
+    void BM_FindMiss(benchmark::State &state)
+    {
+        scc::Internify<std::string> pool;
+        std::vector<scc::Internify<std::string>::InternedPtr> handles;
+        const auto entries = static_cast<int>(state.range(0));
+        for (int i = 0; i < entries; ++i)
+        {
+            handles.push_back(pool.internify("present/key/" + std::to_string(i)));
+        }
+        const std::size_t tableBytes = pool.memory_stats().table_bytes;
+        if (entries == kMaxLoadEntries)
+        {
+            auto extra = pool.internify("present/key/extra");
+            if (pool.memory_stats().table_bytes == tableBytes)
+            {
+                state.SkipWithError("the table did not grow past 3/4 load");
+                return;
+            }
+        }
+
+        std::vector<std::string> absent;
+        absent.reserve(kBatch);
+        for (int i = 0; i < kBatch; ++i)
+        {
+            absent.push_back("absent/key/" + std::to_string(i));
+        }
+        std::size_t i = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(pool.find(absent[i++ & (kBatch - 1)]));
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.counters["load"] = static_cast<double>(entries) / 65536.0;
+    }
+}
+
+BENCHMARK(BM_MissSingleProbe);
+BENCHMARK(BM_MissFindThenInsert);
+BENCHMARK(BM_FindMiss)->Arg(32768)->Arg(kMaxLoadEntries);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+#include <internify.hpp>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr int kNumKeys = 1 << 14;
+    constexpr int kMaxThreads = 32;
+
+    const std::vector<std::string> &keys()
+    {
+        static const std::vector<std::string> keys = []
+        {
+            std::vector<std::string> result;
+            result.reserve(kNumKeys);
+            for (int i = 0; i < kNumKeys; ++i)
+            {
+                result.push_back("ingest/key/" + std::to_string(i));
+            }
+            return result;
+        }();
+        return keys;
+    }
+
+    // Every iteration interns a key and drops the handle right away, so most operations are a miss followed by a
+    // release to zero: both paths take the exclusive lock, which is the write-heavy pattern of the ingest workers.
+    template <typename Pool>
+    void BM_InternReleaseScaling(benchmark::State &state)
+    {
+        static Pool pool;
+        const auto &input = keys();
+        std::size_t i = static_cast<std::size_t>(state.thread_index()) * 7919;
+        for (auto _ : state)
+        {
+            auto ptr = pool.internify(input[i++ & (kNumKeys - 1)]);
+            benchmark::DoNotOptimize(ptr.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_InternReleaseScaling, scc::Internify<std::string>)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_InternReleaseScaling, scc::ShardedInternify<std::string>)->ThreadRange(1, kMaxThreads)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_InternReleaseScaling, scc::ShardedInternify<std::string, std::hash<std::string>, std::equal_to<std::string>, 64>)->ThreadRange(1, kMaxThreads)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+#include <internify.hpp>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    constexpr int kNumKeys = 1 << 18;
+
+    // Short keys in the style of metric tags and header names, spread over a table far larger than the cache.
+    const std::vector<std::string> &keys()
+    {
+        static const std::vector<std::string> keys = []
+        {
+            std::vector<std::string> result;
+            result.reserve(kNumKeys);
+            for (int i = 0; i < kNumKeys; ++i)
+            {
+                result.push_back("tag:" + std::to_string(i * 7919));
+            }
+            return result;
+        }();
+        return keys;
+    }
+
+    template <typename Storage>
+    using Pool = scc::ImmortalInternify<std::string, scc::Hash<std::string>, std::equal_to<>, Storage>;
+
+    // Hits on an immortal pool in random order. With SmallKeySlots the slot alone confirms the hit.
+    template <typename Storage>
+    void BM_ShortKeyHit(benchmark::State &state)
+    {
+        static Pool<Storage> pool;
+        const auto &input = keys();
+        if (pool.size() == 0)
+        {
+            for (const auto &key : input)
+            {
+                (void)pool.internify(key);
+            }
+        }
+        std::size_t i = 0;
+        for (auto _ : state)
+        {
+            auto symbol = pool.find(input[(i++ * 40503) & (kNumKeys - 1)]);
+            benchmark::DoNotOptimize(symbol.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.counters["table_bytes"] = static_cast<double>(pool.memory_stats().table_bytes);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_ShortKeyHit, scc::ValueStorage<std::string>);
+BENCHMARK_TEMPLATE(BM_ShortKeyHit, scc::SmallKeySlots<>);
+BENCHMARK_TEMPLATE(BM_ShortKeyHit, scc::InlineStringStorage<>);
+BENCHMARK_TEMPLATE(BM_ShortKeyHit, scc::SmallKeySlots<scc::InlineStringStorage<>>);
+
+BENCHMARK_MAIN();
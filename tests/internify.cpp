@@ -5,11 +5,60 @@
 #include <vector>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <chrono>
 #include <vector>
 #include <numeric>
 #include <cmath>
 #include <algorithm>
+#include <cstdint>
+#include <atomic>
+#include <future>
+#include <memory_resource>
+
+namespace
+{
+    // Forwards to std::hash<std::string> and counts its calls, to check which operations hash.
+    struct CountingHash
+    {
+        static inline std::atomic<int> calls{0};
+
+        static void reset() { calls = 0; }
+
+        std::size_t operator()(const std::string &value) const
+        {
+            ++calls;
+            return std::hash<std::string>{}(value);
+        }
+    };
+
+    // Forwards to the default resource and keeps track of what is outstanding.
+    class CountingResource : public std::pmr::memory_resource
+    {
+    public:
+        std::size_t outstanding = 0;
+        std::size_t allocations = 0;
+
+    private:
+        void *do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            outstanding += bytes;
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+        {
+            outstanding -= bytes;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+}
 
 TEST(InternifyTest, BasicUsage)
 {
@@ -161,3 +210,1365 @@ TEST(InternifyTest, SimplifiedInternifyComplexity)
     EXPECT_NEAR(timeFor1000 * 10, timeFor10000, timeFor10000 * 0.2);
     EXPECT_NEAR(timeFor1000 * 100, timeFor100000, timeFor100000 * 0.2);
 }
+
+TEST(ShardedInternifyTest, BasicUsage)
+{
+    scc::ShardedInternify<std::string> intern;
+
+    auto str1 = intern.internify("hello");
+    auto str2 = intern.internify("hello");
+    auto str3 = intern.internify("world");
+
+    EXPECT_EQ(str1.get(), str2.get());
+    EXPECT_NE(str1.get(), str3.get());
+    EXPECT_EQ(*str1, "hello");
+    EXPECT_EQ(*str3, "world");
+    EXPECT_EQ(intern.find("hello"), str1);
+    EXPECT_FALSE(intern.find("missing"));
+    EXPECT_EQ(intern.size(), 2);
+}
+
+TEST(ShardedInternifyTest, ThreadSafety)
+{
+    using Pool = scc::ShardedInternify<std::string, std::hash<std::string>, std::equal_to<std::string>, 8>;
+    Pool intern;
+
+    const int numThreads = 10;
+    const int numOperations = 1000;
+    std::vector<std::vector<Pool::InternedPtr>> perThread(numThreads);
+
+    std::vector<std::thread> threads;
+    for (int id = 0; id < numThreads; ++id)
+    {
+        threads.emplace_back([&intern, &perThread, id]()
+                             {
+                                 for (int i = 0; i < numOperations; ++i)
+                                 {
+                                     // Every thread interns the same keys so that shards see both hits and misses.
+                                     perThread[id].emplace_back(intern.internify("sharded" + std::to_string(i)));
+                                 } });
+    }
+
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+
+    EXPECT_EQ(intern.size(), numOperations);
+    for (int i = 0; i < numOperations; ++i)
+    {
+        EXPECT_EQ(perThread[0][i], perThread[numThreads - 1][i]);
+    }
+
+    perThread.clear();
+
+    EXPECT_EQ(intern.size(), 0);
+}
+
+TEST(InternifyTest, ChurnKeepsLiveEntriesReachable)
+{
+    scc::Internify<std::string> intern;
+
+    // Entries that stay alive while many others are inserted and erased around them, so probes have to
+    // walk over erased slots and survive several rehashes.
+    std::vector<scc::Internify<std::string>::InternedPtr> pinned;
+    for (int i = 0; i < 100; ++i)
+    {
+        pinned.push_back(intern.internify("pinned" + std::to_string(i)));
+    }
+
+    for (int round = 0; round < 50; ++round)
+    {
+        std::vector<scc::Internify<std::string>::InternedPtr> transient;
+        for (int i = 0; i < 1000; ++i)
+        {
+            transient.push_back(intern.internify("churn" + std::to_string(round * 1000 + i)));
+        }
+        EXPECT_EQ(intern.size(), 1100);
+    }
+
+    EXPECT_EQ(intern.size(), 100);
+    for (int i = 0; i < 100; ++i)
+    {
+        auto found = intern.find("pinned" + std::to_string(i));
+        EXPECT_EQ(found, pinned[i]);
+        EXPECT_EQ(*found, "pinned" + std::to_string(i));
+    }
+}
+
+TEST(InternifyTest, TableGrowsAtThreeQuartersLoad)
+{
+    scc::Internify<int> intern;
+    std::vector<scc::Internify<int>::InternedPtr> handles;
+    handles.push_back(intern.internify(0));
+    const std::size_t initialTableBytes = intern.memory_stats().table_bytes;
+
+    // The first table has 16 slots and takes 12 entries before it grows.
+    for (int i = 1; i < 12; ++i)
+    {
+        handles.push_back(intern.internify(i));
+        EXPECT_EQ(intern.memory_stats().table_bytes, initialTableBytes);
+    }
+    handles.push_back(intern.internify(12));
+    EXPECT_GT(intern.memory_stats().table_bytes, initialTableBytes);
+}
+
+TEST(InternifyTest, HashCollisionsKeepDistinctValues)
+{
+    // Every value collides, so only the equality predicate can tell them apart.
+    struct ConstantHash
+    {
+        std::uint32_t operator()(const std::string &) const { return 42; }
+    };
+    scc::Internify<std::string, ConstantHash> intern;
+
+    auto a1 = intern.internify("alpha");
+    auto b1 = intern.internify("beta");
+    auto a2 = intern.internify("alpha");
+
+    EXPECT_EQ(a1, a2);
+    EXPECT_NE(a1, b1);
+    EXPECT_EQ(*a1, "alpha");
+    EXPECT_EQ(*b1, "beta");
+    EXPECT_EQ(intern.size(), 2);
+
+    b1.release();
+    EXPECT_EQ(intern.size(), 1);
+    EXPECT_FALSE(intern.find("beta"));
+    EXPECT_EQ(intern.find("alpha"), a1);
+}
+
+TEST(InternifyTest, TruncatedHash)
+{
+    struct Fnv1a32
+    {
+        std::uint32_t operator()(const std::string &value) const
+        {
+            std::uint32_t hash = 2166136261u;
+            for (unsigned char c : value)
+            {
+                hash = (hash ^ c) * 16777619u;
+            }
+            return hash;
+        }
+    };
+    scc::Internify<std::string, Fnv1a32> intern;
+
+    const int numStrings = 10000;
+    std::vector<scc::Internify<std::string, Fnv1a32>::InternedPtr> strings;
+    for (int i = 0; i < numStrings; ++i)
+    {
+        strings.push_back(intern.internify("fnv" + std::to_string(i)));
+    }
+
+    EXPECT_EQ(intern.size(), numStrings);
+    for (int i = 0; i < numStrings; ++i)
+    {
+        EXPECT_EQ(*strings[i], "fnv" + std::to_string(i));
+    }
+}
+
+TEST(InternifyTest, ConcurrentHitsAndReleases)
+{
+    scc::Internify<std::string> intern;
+
+    // Half of the keys stay pinned, so their lookups are lock-free hits; the other half keep dropping to
+    // zero and being erased while other threads are probing for them.
+    const int numKeys = 64;
+    std::vector<std::string> keys;
+    std::vector<scc::Internify<std::string>::InternedPtr> pinned;
+    for (int i = 0; i < numKeys; ++i)
+    {
+        keys.push_back("concurrent" + std::to_string(i));
+        if (i % 2 == 0)
+        {
+            pinned.push_back(intern.internify(keys.back()));
+        }
+    }
+
+    const int numThreads = 8;
+    const int numOperations = 20000;
+    std::vector<std::thread> threads;
+    for (int id = 0; id < numThreads; ++id)
+    {
+        threads.emplace_back([&intern, &keys, id]()
+                             {
+                                 for (int i = 0; i < numOperations; ++i)
+                                 {
+                                     const std::string &key = keys[(i * 7 + id) % numKeys];
+                                     auto ptr = intern.internify(key);
+                                     EXPECT_EQ(*ptr, key);
+                                     auto found = intern.find(key);
+                                     EXPECT_EQ(found, ptr);
+                                 } });
+    }
+
+    for (auto &t : threads)
+    {
+        t.join();
+    }
+
+    EXPECT_EQ(intern.size(), numKeys / 2);
+    pinned.clear();
+    EXPECT_EQ(intern.size(), 0);
+}
+
+TEST(InternifyTest, ReleaseDoesNotRehash)
+{
+    CountingHash::reset();
+    scc::Internify<std::string, CountingHash> intern;
+
+    std::vector<scc::Internify<std::string, CountingHash>::InternedPtr> handles;
+    for (int i = 0; i < 100; ++i)
+    {
+        handles.push_back(intern.internify("shared"));
+    }
+
+    const int callsBeforeRelease = CountingHash::calls.load();
+    handles.erase(handles.begin() + 1, handles.end());
+    EXPECT_EQ(CountingHash::calls.load(), callsBeforeRelease); // non-final releases only decrement the node's count
+    EXPECT_EQ(intern.size(), 1);
+
+    handles.clear();
+    EXPECT_EQ(intern.size(), 0);
+}
+
+TEST(InternifyTest, HeterogeneousLookup)
+{
+    scc::Internify<std::string> intern;
+
+    const char buffer[] = "GET /index.html HTTP/1.1";
+    const std::string_view method(buffer, 3);
+
+    auto fromView = intern.internify(method);
+    auto fromString = intern.internify(std::string("GET"));
+    auto fromBuffer = intern.internify(buffer, 3);
+
+    EXPECT_EQ(fromView, fromString);
+    EXPECT_EQ(fromView, fromBuffer);
+    EXPECT_EQ(*fromView, "GET");
+    EXPECT_EQ(intern.size(), 1);
+
+    EXPECT_EQ(intern.find(std::string_view("GET")), fromView);
+    EXPECT_FALSE(intern.find(std::string_view(buffer + 4, 11)));
+
+    // The transparent default hash agrees with std::hash, so views and strings land on the same entry.
+    EXPECT_EQ(scc::Hash<std::string>{}(method), std::hash<std::string>{}("GET"));
+}
+
+TEST(InternifyTest, NonStringValues)
+{
+    scc::Internify<int> intern;
+
+    auto a = intern.internify(42);
+    auto b = intern.internify(42);
+    auto c = intern.internify(7);
+
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(*a, 42);
+    EXPECT_EQ(intern.size(), 2);
+}
+
+TEST(ShardedInternifyTest, HeterogeneousLookup)
+{
+    scc::ShardedInternify<std::string> intern;
+
+    auto fromView = intern.internify(std::string_view("header"));
+    auto fromString = intern.internify(std::string("header"));
+
+    EXPECT_EQ(fromView, fromString);
+    EXPECT_EQ(intern.find(std::string_view("header")), fromView);
+    EXPECT_EQ(intern.size(), 1);
+}
+
+TEST(InternifyTest, MoveInsertion)
+{
+    scc::Internify<std::string> intern;
+
+    // Long enough to live on the heap, so a move hands the buffer over.
+    std::string blob(256, 'b');
+    const char *buffer = blob.data();
+
+    auto moved = intern.internify(std::move(blob));
+    EXPECT_EQ(moved->data(), buffer); // the miss stole the caller's buffer
+    EXPECT_EQ(*moved, std::string(256, 'b'));
+
+    std::string again(256, 'b');
+    auto hit = intern.internify(std::move(again));
+    EXPECT_EQ(hit, moved);
+    EXPECT_EQ(again, std::string(256, 'b')); // a hit leaves the argument unchanged
+
+    auto emplaced = intern.internify_emplace(256, 'b');
+    EXPECT_EQ(emplaced, moved);
+
+    auto fresh = intern.internify_emplace(3, 'x');
+    EXPECT_EQ(*fresh, "xxx");
+    EXPECT_EQ(intern.size(), 2);
+}
+
+TEST(InternifyTest, InternifyHashesOnce)
+{
+    CountingHash::reset();
+    scc::Internify<std::string, CountingHash> intern;
+
+    auto miss = intern.internify("once");
+    EXPECT_EQ(CountingHash::calls.load(), 1); // the lock-free probe and the insertion share one hash
+
+    auto hit = intern.internify("once");
+    EXPECT_EQ(CountingHash::calls.load(), 2);
+    EXPECT_EQ(miss, hit);
+}
+
+TEST(InternifyTest, PrehashedApi)
+{
+    CountingHash::reset();
+    scc::Internify<std::string, CountingHash> intern;
+
+    // A hash that travelled with the key, e.g. in a network frame.
+    const std::size_t frameHash = 0x1234abcd5678ef00ull;
+
+    auto first = intern.internify_prehashed(frameHash, "frame-key");
+    auto second = intern.internify_prehashed(frameHash, std::string("frame-key"));
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(first.hash(), frameHash);
+    EXPECT_EQ(intern.find_prehashed(frameHash, "frame-key"), first);
+    EXPECT_FALSE(intern.find_prehashed(frameHash, "other-key"));
+
+    first.release();
+    second.release();
+    EXPECT_EQ(intern.size(), 0);
+    EXPECT_EQ(CountingHash::calls.load(), 0); // neither lookups nor the final release ran HashFunc
+
+    auto hashed = intern.internify("regular");
+    EXPECT_EQ(hashed.hash(), std::hash<std::string>{}("regular"));
+}
+
+TEST(ShardedInternifyTest, HashesOnce)
+{
+    CountingHash::reset();
+    scc::ShardedInternify<std::string, CountingHash> intern;
+
+    auto ptr = intern.internify("sharded-once");
+    EXPECT_EQ(CountingHash::calls.load(), 1); // the shard choice and the shard's own lookup share one hash
+    EXPECT_EQ(intern.find_prehashed(ptr.hash(), "sharded-once"), ptr);
+}
+
+TEST(InternifyTest, CopyableHandles)
+{
+    CountingHash::reset();
+    scc::Internify<std::string, CountingHash> intern;
+
+    auto original = intern.internify("shared");
+    CountingHash::reset();
+    {
+        auto copy = original;
+        EXPECT_EQ(copy, original);
+        EXPECT_EQ(*copy, "shared");
+
+        std::vector<decltype(original)> fanOut(8, original);
+        auto fanOutCopy = fanOut;
+        EXPECT_EQ(fanOutCopy.back(), original);
+
+        auto other = intern.internify("other");
+        other = copy;
+        EXPECT_EQ(other, original);
+        EXPECT_FALSE(intern.find("other")); // the assigned-over reference was released
+        auto &alias = other;
+        other = alias;
+        EXPECT_EQ(other, original);
+    }
+    EXPECT_EQ(CountingHash::calls.load(), 2); // only internify("other") and find("other"); copies never went back to the pool
+    EXPECT_EQ(intern.size(), 1);
+
+    original.release();
+    EXPECT_EQ(intern.size(), 0);
+}
+
+TEST(InternifyTest, ConcurrentCopies)
+{
+    scc::Internify<std::string> intern;
+    auto root = intern.internify("fan-out");
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&root]
+                             {
+            for (int i = 0; i < 10000; ++i)
+            {
+                auto copy = root;
+                auto second = copy;
+                EXPECT_EQ(*second, "fan-out");
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(intern.size(), 1);
+    root.release();
+    EXPECT_EQ(intern.size(), 0);
+}
+
+TEST(InternifyTest, ArenaStringStorage)
+{
+    using Pool = scc::Internify<std::string, scc::Hash<std::string>, std::equal_to<>, scc::ArenaStringStorage<>>;
+    static_assert(std::is_same_v<Pool::value_type, std::string_view>);
+    Pool intern;
+
+    auto alpha = intern.internify("alpha");
+    auto beta = intern.internify(std::string("beta"));
+    auto empty = intern.internify("");
+    auto large = intern.internify(std::string(100000, 'x'));
+
+    EXPECT_EQ(*alpha, "alpha");
+    EXPECT_EQ(*beta, "beta");
+    EXPECT_EQ(beta->data(), alpha->data() + alpha->size()); // packed back to back, no per-string header
+    EXPECT_TRUE(empty->empty());
+    EXPECT_EQ(large->size(), 100000u);
+
+    EXPECT_EQ(intern.internify(std::string_view("alpha")), alpha);
+    EXPECT_EQ(intern.find("beta"), beta);
+    EXPECT_EQ(intern.find(std::string(100000, 'x')), large);
+
+    std::vector<std::string_view> seen;
+    intern.for_each([&seen](std::string_view value)
+                    { seen.push_back(value); });
+    std::sort(seen.begin(), seen.end());
+    EXPECT_EQ(seen.size(), 4u);
+    EXPECT_EQ(seen[1], "alpha");
+
+    alpha.release();
+    beta.release();
+    empty.release();
+    large.release();
+    intern.compact();
+    EXPECT_EQ(intern.size(), 0);
+}
+
+TEST(InternifyTest, ArenaStringStorageChunks)
+{
+    scc::ArenaStringStorage<char, std::char_traits<char>, 4096> storage;
+
+    std::vector<std::string_view> first;
+    for (int i = 0; i < 1000; ++i)
+    {
+        first.push_back(storage.store(std::string("string-") + std::to_string(i)));
+    }
+    const std::size_t chunks = storage.chunk_count();
+    EXPECT_GT(chunks, 1u);
+    EXPECT_EQ(first[999], "string-999");
+
+    // Emptied chunks are recycled instead of growing the arena.
+    for (auto value : first)
+    {
+        storage.discard(value);
+    }
+    for (int i = 0; i < 1000; ++i)
+    {
+        storage.discard(storage.store(std::string("string-") + std::to_string(i)));
+    }
+    EXPECT_EQ(storage.chunk_count(), chunks);
+
+    auto big = storage.store(std::string(10000, 'y'));
+    EXPECT_EQ(big, std::string(10000, 'y'));
+    storage.discard(big);
+
+    storage.compact();
+    EXPECT_EQ(storage.chunk_count(), 0u);
+}
+
+TEST(InternifyTest, ArenaStringStorageEmptiedLargeChunk)
+{
+    scc::ArenaStringStorage<char, std::char_traits<char>, 4096> storage;
+
+    // The large chunk is the current one when its string goes; small strings must not be packed into it.
+    storage.discard(storage.store(std::string(10000, 'x')));
+    std::vector<std::string_view> small;
+    for (int i = 0; i < 200; ++i)
+    {
+        small.push_back(storage.store(std::string(40, 'a')));
+    }
+    storage.discard(small.back());
+    small.pop_back();
+    for (auto value : small)
+    {
+        EXPECT_EQ(value, std::string(40, 'a'));
+    }
+    for (auto value : small)
+    {
+        storage.discard(value);
+    }
+    storage.compact();
+    EXPECT_EQ(storage.chunk_count(), 0u);
+}
+
+TEST(ShardedInternifyTest, ArenaStringStorage)
+{
+    scc::ShardedInternify<std::string, scc::Hash<std::string>, std::equal_to<>, 4, scc::ArenaStringStorage<>> intern;
+
+    auto a = intern.internify("sharded-arena");
+    EXPECT_EQ(intern.find(std::string_view("sharded-arena")), a);
+    std::size_t count = 0;
+    intern.for_each([&count](std::string_view)
+                    { ++count; });
+    EXPECT_EQ(count, 1u);
+    a.release();
+    intern.compact();
+    EXPECT_EQ(intern.size(), 0);
+}
+
+TEST(InternifyTest, SymbolIds)
+{
+    static_assert(sizeof(scc::SymbolId) == 4);
+    scc::Internify<std::string> intern;
+
+    const scc::SymbolId apple = intern.internify_id("apple");
+    const scc::SymbolId banana = intern.internify_id(std::string("banana"));
+    EXPECT_NE(apple, scc::kNoSymbol);
+    EXPECT_NE(apple, banana);
+    EXPECT_EQ(intern.internify_id(std::string_view("apple")), apple); // now owns two references
+    EXPECT_EQ(intern.resolve(apple), "apple");
+    EXPECT_EQ(intern.resolve(banana), "banana");
+
+    // Handles and ids name the same entry and share its reference count.
+    auto handle = intern.find("apple");
+    EXPECT_EQ(intern.to_id(std::move(handle)), apple);
+    EXPECT_FALSE(handle);
+    intern.retain(apple);
+    for (int i = 0; i < 4; ++i)
+    {
+        EXPECT_EQ(intern.resolve(apple), "apple");
+        intern.release(apple);
+    }
+    EXPECT_FALSE(intern.find("apple"));
+
+    // The released id is handed out again.
+    const scc::SymbolId cherry = intern.internify_id("cherry");
+    EXPECT_EQ(cherry, apple);
+    EXPECT_EQ(intern.resolve(cherry), "cherry");
+
+    // Enough ids to span several index segments.
+    std::vector<scc::SymbolId> ids;
+    for (int i = 0; i < 10000; ++i)
+    {
+        ids.push_back(intern.internify_id(std::to_string(i)));
+    }
+    for (int i = 0; i < 10000; ++i)
+    {
+        EXPECT_EQ(intern.resolve(ids[i]), std::to_string(i));
+        intern.release(ids[i]);
+    }
+    intern.release(banana);
+    intern.release(cherry);
+    EXPECT_EQ(intern.size(), 0);
+}
+
+TEST(ShardedInternifyTest, SymbolIds)
+{
+    scc::ShardedInternify<std::string> intern;
+
+    std::vector<scc::SymbolId> ids;
+    for (int i = 0; i < 1000; ++i)
+    {
+        ids.push_back(intern.internify_id(std::to_string(i)));
+    }
+    std::vector<scc::SymbolId> sorted = ids;
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(std::unique(sorted.begin(), sorted.end()), sorted.end()); // unique across shards
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_EQ(intern.resolve(ids[i]), std::to_string(i));
+        EXPECT_EQ(intern.to_id(intern.internify(std::to_string(i))), ids[i]);
+        intern.release(ids[i]);
+        intern.release(ids[i]);
+    }
+    EXPECT_EQ(intern.size(), 0);
+}
+
+TEST(InternifyTest, ConcurrentSymbolIds)
+{
+    scc::Internify<std::string> intern;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&intern, t]
+                             {
+            for (int i = 0; i < 2000; ++i)
+            {
+                const std::string key = std::to_string((i * 7 + t) % 300);
+                const scc::SymbolId id = intern.internify_id(key);
+                EXPECT_EQ(intern.resolve(id), key);
+                intern.release(id);
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(intern.size(), 0);
+}
+
+TEST(ImmortalInternifyTest, BasicUsage)
+{
+    using Pool = scc::ImmortalInternify<std::string>;
+    static_assert(std::is_trivially_copyable_v<Pool::Symbol>);
+    static_assert(sizeof(Pool::Symbol) == sizeof(void *));
+    Pool intern;
+
+    auto a = intern.internify("symbol");
+    auto b = intern.internify(std::string_view("symbol"));
+    auto c = intern.internify(std::string("other"));
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(*a, "symbol");
+    EXPECT_EQ(intern.find("other"), c);
+    EXPECT_FALSE(intern.find("missing"));
+    EXPECT_EQ(intern.size(), 2);
+
+    // Enough inserts to replace the table several times; earlier symbols stay valid and findable.
+    for (int i = 0; i < 10000; ++i)
+    {
+        (void)intern.internify(std::to_string(i));
+    }
+    EXPECT_EQ(*a, "symbol");
+    EXPECT_EQ(intern.find("symbol"), a);
+    EXPECT_EQ(intern.size(), 10002);
+}
+
+TEST(ImmortalInternifyTest, ThreadSafety)
+{
+    scc::ImmortalInternify<std::string> intern;
+    auto anchor = intern.internify("anchor");
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&intern, anchor, t]
+                             {
+            for (int i = 0; i < 2000; ++i)
+            {
+                const std::string key = std::to_string(i * 8 + t);
+                auto symbol = intern.internify(key);
+                EXPECT_EQ(*symbol, key);
+                EXPECT_EQ(intern.find("anchor"), anchor);
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(intern.size(), 16001);
+}
+
+TEST(InternifyTest, ChurnReusesNodes)
+{
+    scc::Internify<std::string> intern;
+    auto keep = intern.internify("keep");
+
+    auto apple = intern.internify("apple");
+    const std::string *first = apple.get();
+    apple.release();
+    intern.compact(); // frees the erased node once no reader can see it
+
+    // The next node comes off the free list instead of the global allocator.
+    auto again = intern.internify("apple");
+    EXPECT_EQ(again.get(), first);
+    EXPECT_EQ(*again, "apple");
+
+    for (int round = 0; round < 100; ++round)
+    {
+        std::vector<decltype(keep)> handles;
+        for (int i = 0; i < 200; ++i)
+        {
+            handles.push_back(intern.internify(std::to_string(i)));
+        }
+        for (int i = 0; i < 200; ++i)
+        {
+            EXPECT_EQ(*handles[i], std::to_string(i));
+        }
+    }
+    EXPECT_EQ(intern.size(), 2);
+    EXPECT_EQ(*keep, "keep");
+}
+
+TEST(InternifyTest, MemoryResource)
+{
+    CountingResource resource;
+    {
+        scc::Internify<std::pmr::string> intern(&resource);
+        auto ptr = intern.internify("a string well beyond the small string buffer");
+        EXPECT_EQ(ptr->get_allocator().resource(), &resource); // value bytes come from the pool's resource too
+        EXPECT_EQ(intern.find(std::string_view("a string well beyond the small string buffer")), ptr);
+
+        const std::size_t allocations = resource.allocations;
+        EXPECT_GE(allocations, 3u); // table, node slab, string contents
+        std::vector<decltype(ptr)> handles;
+        for (int i = 0; i < 1000; ++i)
+        {
+            handles.push_back(intern.internify(std::pmr::string(std::to_string(i), &resource)));
+        }
+        EXPECT_GT(resource.allocations, allocations);
+    }
+    EXPECT_EQ(resource.outstanding, 0u);
+
+    {
+        scc::Internify<std::string, scc::Hash<std::string>, std::equal_to<>, scc::ArenaStringStorage<>> intern(&resource);
+        auto ptr = intern.internify("arena");
+        EXPECT_GE(resource.outstanding, 64u * 1024); // the arena chunk
+    }
+    EXPECT_EQ(resource.outstanding, 0u);
+
+    {
+        scc::ShardedInternify<std::pmr::string, scc::Hash<std::pmr::string>, std::equal_to<>, 4> intern(&resource);
+        auto ptr = intern.internify("sharded");
+        EXPECT_GT(resource.outstanding, 0u);
+    }
+    EXPECT_EQ(resource.outstanding, 0u);
+}
+
+TEST(ImmortalInternifyTest, MonotonicResource)
+{
+    std::pmr::monotonic_buffer_resource arena;
+    scc::ImmortalInternify<std::pmr::string> intern(&arena);
+    for (int i = 0; i < 1000; ++i)
+    {
+        const std::string key = "request-scoped/" + std::to_string(i);
+        auto symbol = intern.internify(std::string_view(key));
+        EXPECT_EQ(symbol->get_allocator().resource(), &arena);
+    }
+    EXPECT_EQ(*intern.find("request-scoped/42"), "request-scoped/42");
+}
+
+TEST(InternifyTest, InlineStringStorage)
+{
+    using Pool = scc::Internify<std::string, scc::Hash<std::string>, std::equal_to<>, scc::InlineStringStorage<>>;
+    static_assert(std::is_same_v<Pool::value_type, std::string_view>);
+
+    CountingResource resource;
+    {
+        Pool intern(&resource);
+        const std::string key = "a string well beyond the small string buffer";
+        auto ptr = intern.internify(key);
+        EXPECT_EQ(*ptr, key);
+        EXPECT_EQ(ptr->data()[ptr->size()], '\0');
+        EXPECT_EQ(intern.internify(std::string_view(key)), ptr);
+
+        // The characters follow the node header, within the cache line of the view and the reference count.
+        const auto offset = ptr->data() - reinterpret_cast<const char *>(ptr.get());
+        EXPECT_GE(offset, static_cast<std::ptrdiff_t>(sizeof(std::string_view)));
+        EXPECT_LT(offset, 64);
+
+        // Nodes are pooled by size, so a thousand entries take far fewer upstream allocations.
+        const std::size_t before = resource.allocations;
+        std::vector<decltype(ptr)> handles;
+        for (int i = 0; i < 1000; ++i)
+        {
+            handles.push_back(intern.internify("a string well beyond the small string buffer #" + std::to_string(i)));
+        }
+        EXPECT_LT(resource.allocations - before, 100u);
+
+        auto empty = intern.internify("");
+        EXPECT_TRUE(empty->empty());
+        EXPECT_EQ(intern.find(""), empty);
+
+        ptr.release();
+        intern.compact();
+        EXPECT_FALSE(intern.find(key));
+    }
+    EXPECT_EQ(resource.outstanding, 0u);
+
+    scc::ShardedInternify<std::string, scc::Hash<std::string>, std::equal_to<>, 4, scc::InlineStringStorage<>> sharded;
+    EXPECT_EQ(*sharded.internify("sharded-inline"), "sharded-inline");
+    scc::ImmortalInternify<std::string, scc::Hash<std::string>, std::equal_to<>, scc::InlineStringStorage<>> immortal;
+    EXPECT_EQ(*immortal.internify("immortal-inline"), "immortal-inline");
+}
+
+TEST(InternifyTest, MemoryStats)
+{
+    scc::Internify<std::string> intern;
+    auto empty = intern.memory_stats();
+    EXPECT_EQ(empty.live_entries, 0u);
+    EXPECT_EQ(empty.total_bytes(), 0u);
+
+    const std::string longValue(100, 'v');
+    std::vector<scc::Internify<std::string>::InternedPtr> handles;
+    for (int i = 0; i < 10; ++i)
+    {
+        handles.push_back(intern.internify(longValue));
+    }
+    auto shortValue = intern.internify("short");
+    auto copy = shortValue;
+    const scc::SymbolId id = intern.internify_id("short");
+
+    auto stats = intern.memory_stats();
+    EXPECT_EQ(stats.live_entries, 2u);
+    EXPECT_EQ(stats.total_references, 13u);
+    EXPECT_DOUBLE_EQ(stats.dedup_ratio, 6.5);
+    EXPECT_EQ(stats.value_bytes, 105u);
+    EXPECT_GT(stats.node_bytes, 0u);
+    EXPECT_GT(stats.table_bytes, 0u);
+    EXPECT_GE(stats.slack_bytes, 1u); // at least the long string's terminator, plus the free slab slots
+    EXPECT_EQ(stats.total_bytes(), stats.value_bytes + stats.node_bytes + stats.table_bytes + stats.slack_bytes);
+
+    handles.clear();
+    copy.release();
+    intern.release(id);
+    stats = intern.memory_stats();
+    EXPECT_EQ(stats.live_entries, 1u);
+    EXPECT_EQ(stats.total_references, 1u);
+    EXPECT_EQ(stats.value_bytes, 5u);
+}
+
+TEST(InternifyTest, MemoryStatsStorages)
+{
+    scc::Internify<std::string, scc::Hash<std::string>, std::equal_to<>, scc::ArenaStringStorage<>> arena;
+    auto a = arena.internify("arena-string");
+    auto stats = arena.memory_stats();
+    EXPECT_EQ(stats.value_bytes, 12u);
+    EXPECT_GE(stats.slack_bytes, 60000u); // the rest of the first chunk
+
+    scc::ShardedInternify<int> sharded;
+    std::vector<scc::ShardedInternify<int>::InternedPtr> handles;
+    for (int i = 0; i < 100; ++i)
+    {
+        handles.push_back(sharded.internify(i));
+        handles.push_back(sharded.internify(i));
+    }
+    stats = sharded.memory_stats();
+    EXPECT_EQ(stats.live_entries, 100u);
+    EXPECT_EQ(stats.total_references, 200u);
+    EXPECT_DOUBLE_EQ(stats.dedup_ratio, 2.0);
+    EXPECT_EQ(stats.value_bytes, 100 * sizeof(int));
+}
+
+TEST(InternifyTest, ShrinkAfterMassRelease)
+{
+    CountingResource resource;
+    {
+        scc::Internify<std::string> internify(&resource);
+        std::vector<scc::Internify<std::string>::InternedPtr> handles;
+        for (int i = 0; i < 10000; ++i)
+        {
+            handles.push_back(internify.internify("shrink-" + std::to_string(i)));
+        }
+        const auto full = internify.memory_stats();
+
+        // Keep the first 50 entries, release the rest.
+        std::vector<scc::Internify<std::string>::InternedPtr> kept(std::make_move_iterator(handles.begin()),
+                                                                    std::make_move_iterator(handles.begin() + 50));
+        handles.clear();
+        const scc::SymbolId id = internify.internify_id(std::string("shrink-42"));
+
+        internify.shrink_to_fit();
+        EXPECT_EQ(internify.size(), 50u);
+
+        // Once the old table and the released nodes are reclaimed, only the slabs holding live nodes remain.
+        internify.compact();
+        const auto stats = internify.memory_stats();
+        EXPECT_LT(stats.table_bytes * 100, full.table_bytes);
+        EXPECT_LT(stats.total_bytes() * 20, full.total_bytes());
+        EXPECT_LT(resource.outstanding * 20, full.total_bytes());
+
+        // Live handles and ids survive, and the pool keeps working.
+        for (std::size_t i = 0; i < kept.size(); ++i)
+        {
+            EXPECT_EQ(*kept[i], "shrink-" + std::to_string(i));
+            EXPECT_EQ(internify.internify("shrink-" + std::to_string(i)), kept[i]);
+        }
+        EXPECT_EQ(internify.resolve(id), "shrink-42");
+        internify.release(id);
+        EXPECT_EQ(*internify.internify("shrink-7"), "shrink-7");
+
+        kept.clear();
+        internify.compact();
+        EXPECT_EQ(internify.memory_stats().table_bytes, 0u);
+        EXPECT_EQ(internify.size(), 0u);
+        EXPECT_EQ(*internify.internify("again"), "again");
+    }
+    EXPECT_EQ(resource.outstanding, 0u);
+}
+
+TEST(ShardedInternifyTest, AutoShrink)
+{
+    scc::ShardedInternify<int, scc::Hash<int>, std::equal_to<>, 4> internify;
+    internify.set_auto_shrink(true);
+    std::vector<scc::ShardedInternify<int, scc::Hash<int>, std::equal_to<>, 4>::InternedPtr> handles;
+    for (int i = 0; i < 20000; ++i)
+    {
+        handles.push_back(internify.internify(i));
+    }
+    const std::size_t full = internify.memory_stats().table_bytes;
+    handles.erase(handles.begin() + 100, handles.end());
+    EXPECT_EQ(internify.size(), 100u);
+    EXPECT_LT(internify.memory_stats().table_bytes * 50, full);
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(*handles[i], i);
+        EXPECT_EQ(internify.find(i), handles[i]);
+    }
+}
+
+TEST(InternifyTest, SmallKeySlots)
+{
+    using Pool = scc::Internify<std::string, scc::Hash<std::string>, std::equal_to<>, scc::SmallKeySlots<>>;
+    Pool internify;
+    const std::string longKey(100, 'x');
+    std::vector<Pool::InternedPtr> handles;
+    for (int i = 0; i < 1000; ++i)
+    {
+        handles.push_back(internify.internify("tag-" + std::to_string(i)));
+        handles.push_back(internify.internify(longKey + std::to_string(i)));
+    }
+    EXPECT_EQ(internify.size(), 2000u);
+    for (int i = 0; i < 1000; ++i)
+    {
+        const std::string tag = "tag-" + std::to_string(i);
+        EXPECT_EQ(internify.internify(std::string_view(tag)), handles[2 * i]);
+        EXPECT_EQ(internify.find(tag.c_str()), handles[2 * i]);
+        EXPECT_EQ(internify.internify(longKey + std::to_string(i)), handles[2 * i + 1]);
+    }
+    EXPECT_FALSE(internify.find("tag-"));
+    EXPECT_FALSE(internify.find(longKey));
+    EXPECT_EQ(*internify.internify(""), "");
+
+    // Keys at the inline limit and one past it, and released keys that come back.
+    const std::string edge(23, 'e');
+    auto atLimit = internify.internify(edge);
+    auto pastLimit = internify.internify(edge + "e");
+    EXPECT_NE(atLimit, pastLimit);
+    EXPECT_EQ(internify.find(edge), atLimit);
+    EXPECT_EQ(internify.find(edge + "e"), pastLimit);
+    handles.clear();
+    EXPECT_FALSE(internify.find("tag-7"));
+    EXPECT_EQ(*internify.internify("tag-7"), "tag-7");
+
+    scc::ImmortalInternify<std::string, scc::Hash<std::string>, std::equal_to<>, scc::SmallKeySlots<scc::InlineStringStorage<>, 8>> immortal;
+    const auto symbol = immortal.internify("header");
+    EXPECT_EQ(immortal.internify(std::string("header")), symbol);
+    EXPECT_EQ(immortal.find("header"), symbol);
+    EXPECT_EQ(*immortal.internify("a-longer-header"), "a-longer-header");
+    EXPECT_FALSE(immortal.find("head"));
+}
+
+TEST(InternifyTest, HugePageResource)
+{
+    scc::HugePageResource resource;
+    {
+        scc::Internify<std::uint64_t> internify(&resource);
+        std::vector<scc::Internify<std::uint64_t>::InternedPtr> handles;
+        for (std::uint64_t i = 0; i < 100000; ++i)
+        {
+            handles.push_back(internify.internify(i));
+        }
+        for (std::uint64_t i = 0; i < 100000; i += 997)
+        {
+            EXPECT_EQ(internify.find(i), handles[i]);
+        }
+
+        handles.clear();
+        internify.compact();
+        EXPECT_EQ(internify.size(), 0u);
+        EXPECT_EQ(*internify.internify(std::uint64_t{42}), 42u);
+    }
+
+    // Small blocks honour their alignment, large ones start on a huge page.
+    void *small = resource.allocate(100, 64);
+    void *chunk = resource.allocate(64 * 1024, 64 * 1024);
+    void *large = resource.allocate(3 << 20, 8);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(small) % 64, 0u);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(chunk) % (64 * 1024), 0u);
+#if defined(__linux__)
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(large) % scc::HugePageResource::kHugePageSize, 0u);
+#endif
+    std::fill_n(static_cast<char *>(large), 3 << 20, 'x');
+    resource.deallocate(large, 3 << 20, 8);
+    resource.deallocate(chunk, 64 * 1024, 64 * 1024);
+    resource.deallocate(small, 100, 64);
+}
+
+TEST(InternifyTest, FrontCache)
+{
+    using Pool = scc::Internify<std::string>;
+    Pool internify;
+    Pool::reset_front_cache_stats();
+    auto first = internify.internify_cached(std::string_view("content-type"));
+    auto second = internify.internify_cached(std::string("content-type"));
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(Pool::front_cache_stats().hits, 1u);
+    EXPECT_EQ(Pool::front_cache_stats().misses, 1u);
+
+    // An erase invalidates the entry, even once the node has been recycled for another value.
+    first.release();
+    second.release();
+    internify.compact();
+    auto other = internify.internify("accept");
+    auto again = internify.internify_cached("content-type");
+    EXPECT_EQ(*again, "content-type");
+    EXPECT_EQ(*other, "accept");
+    EXPECT_EQ(Pool::front_cache_stats().misses, 2u);
+
+    // Pools of the same type share the cache but never each other's entries.
+    Pool another;
+    auto foreign = another.internify_cached("content-type");
+    EXPECT_NE(foreign, again);
+    EXPECT_EQ(Pool::front_cache_stats().misses, 3u);
+
+    // Counters are per thread.
+    std::thread([&internify]
+                {
+                    EXPECT_EQ(Pool::front_cache_stats().hits, 0u);
+                    for (int i = 0; i < 100; ++i)
+                    {
+                        EXPECT_EQ(*internify.internify_cached("content-type"), "content-type");
+                    }
+                    EXPECT_EQ(Pool::front_cache_stats().misses, 1u);
+                    EXPECT_DOUBLE_EQ(Pool::front_cache_stats().hit_rate(), 0.99); })
+        .join();
+    EXPECT_EQ(Pool::front_cache_stats().hits, 1u);
+
+    scc::ShardedInternify<std::string> sharded;
+    auto a = sharded.internify_cached("x-request-id");
+    EXPECT_EQ(sharded.internify_cached("x-request-id"), a);
+    EXPECT_EQ(sharded.find("x-request-id"), a);
+}
+
+TEST(InternifyTest, ConcurrentFrontCache)
+{
+    scc::Internify<std::string> internify;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&internify, t]
+                             {
+                                 for (int i = 0; i < 20000; ++i)
+                                 {
+                                     // Hot keys through the cache, interleaved with churn that keeps erasing entries.
+                                     const std::string key = "hot-" + std::to_string(i % 32);
+                                     EXPECT_EQ(*internify.internify_cached(key), key);
+                                     auto cold = internify.internify("cold-" + std::to_string(t) + "-" + std::to_string(i));
+                                 } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(internify.size(), 0u);
+}
+
+TEST(InternifyTest, DeferredRefCounts)
+{
+    scc::Internify<std::string> internify(scc::deferred_refcounts);
+    {
+        auto a = internify.internify("deferred");
+        std::vector<scc::Internify<std::string>::InternedPtr> copies(100, a);
+        EXPECT_EQ(internify.memory_stats().total_references, 101u);
+        EXPECT_EQ(internify.reconcile(), 0u);
+        EXPECT_EQ(*copies.back(), "deferred");
+    }
+    // The last reference is gone, but the entry stays until the pool reconciles.
+    EXPECT_EQ(internify.size(), 1u);
+    auto revived = internify.find("deferred");
+    ASSERT_TRUE(revived);
+    EXPECT_EQ(internify.reconcile(), 0u);
+    revived.release();
+    EXPECT_EQ(internify.reconcile(), 1u);
+    EXPECT_EQ(internify.size(), 0u);
+    EXPECT_FALSE(internify.find("deferred"));
+
+    // A copy taken in one thread and the original dropped in another.
+    auto original = internify.internify("handed-over");
+    auto copy = internify.find("missing");
+    std::thread([&original, &copy]
+                { copy = original; })
+        .join();
+    original.release();
+    EXPECT_EQ(internify.reconcile(), 0u);
+    EXPECT_EQ(*copy, "handed-over");
+
+    const scc::SymbolId id = internify.internify_id(std::string("by-id"));
+    internify.retain(id);
+    internify.release(id);
+    EXPECT_EQ(internify.reconcile(), 0u);
+    internify.release(id);
+    copy.release();
+    EXPECT_EQ(internify.reconcile(), 2u);
+
+    // Growing the table reconciles first, so dead entries do not pile up.
+    for (int i = 0; i < 10000; ++i)
+    {
+        auto transient = internify.internify("transient-" + std::to_string(i));
+    }
+    EXPECT_LT(internify.size(), 100u);
+
+    scc::ShardedInternify<int> sharded(scc::deferred_refcounts);
+    {
+        auto seven = sharded.internify(7);
+        auto again = seven;
+    }
+    EXPECT_EQ(sharded.size(), 1u);
+    EXPECT_EQ(sharded.reconcile(), 1u);
+}
+
+TEST(ShardedInternifyTest, ConcurrentDeferredRefCounts)
+{
+    scc::ShardedInternify<std::string, scc::Hash<std::string>, std::equal_to<>, 4> internify(scc::deferred_refcounts);
+    auto hot = internify.internify("hot");
+    std::atomic<bool> done{false};
+    std::thread reconciler([&internify, &done]
+                           {
+                               while (!done.load())
+                               {
+                                   internify.reconcile();
+                                   std::this_thread::yield();
+                               } });
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&internify, &hot, t]
+                             {
+                                 std::vector<decltype(hot)> held;
+                                 for (int i = 0; i < 20000; ++i)
+                                 {
+                                     held.push_back(hot);
+                                     auto key = "key-" + std::to_string(i % 200);
+                                     auto ptr = internify.internify(key);
+                                     EXPECT_EQ(*ptr, key);
+                                     auto copy = ptr;
+                                     EXPECT_EQ(*internify.internify_cached(key), key);
+                                     if (i % (64 + t) == 0)
+                                     {
+                                         held.clear();
+                                     }
+                                 } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    done = true;
+    reconciler.join();
+    EXPECT_EQ(*hot, "hot");
+    hot.release();
+    internify.reconcile();
+    EXPECT_EQ(internify.size(), 0u);
+}
+
+TEST(InternifyTest, BorrowedValues)
+{
+    scc::Internify<std::string> internify;
+    auto owner = internify.internify("borrowed");
+    EXPECT_EQ(internify.memory_stats().total_references, 1u);
+
+    std::size_t length = 0;
+    EXPECT_TRUE(internify.with_interned(std::string_view("borrowed"), [&length](const std::string &value)
+                                        { length = value.size(); }));
+    EXPECT_EQ(length, 8u);
+    EXPECT_FALSE(internify.with_interned(std::string("absent"), [](const std::string &)
+                                         { FAIL(); }));
+
+    {
+        scc::ReadGuard guard;
+        const std::string *value = internify.borrow(guard, "borrowed");
+        ASSERT_NE(value, nullptr);
+        EXPECT_EQ(value, owner.get());
+        EXPECT_EQ(internify.borrow(guard, "absent"), nullptr);
+        EXPECT_EQ(internify.memory_stats().total_references, 1u);
+
+        // Erased and compacted by another thread while borrowed: the memory outlives the guard's scope.
+        std::thread([&internify, &owner]
+                    {
+                        owner.release();
+                        internify.compact(); })
+            .join();
+        EXPECT_EQ(internify.size(), 0u);
+        EXPECT_EQ(*value, "borrowed");
+    }
+    internify.compact();
+    EXPECT_EQ(internify.memory_stats().slack_bytes, 0u);
+
+    scc::ShardedInternify<int> sharded;
+    auto five = sharded.internify(5);
+    scc::ReadGuard guard;
+    EXPECT_EQ(sharded.borrow(guard, 5), five.get());
+    EXPECT_TRUE(sharded.with_interned(5, [](int value)
+                                      { EXPECT_EQ(value, 5); }));
+
+#ifndef NDEBUG
+    // A guard created on another thread does not protect this one. That thread lives in this process, so the
+    // death test's child only makes the call.
+    std::promise<scc::ReadGuard *> created;
+    std::promise<void> done;
+    std::thread holder([&created, &done]
+                       {
+                           scc::ReadGuard foreign;
+                           created.set_value(&foreign);
+                           done.get_future().wait(); });
+    scc::ReadGuard *foreign = created.get_future().get();
+    EXPECT_DEATH((void)sharded.borrow(*foreign, 5), "ReadGuard created on the calling thread");
+    done.set_value();
+    holder.join();
+#endif
+}
+
+TEST(InternifyTest, ZombieRetention)
+{
+    CountingResource resource;
+    scc::Internify<std::string> internify(&resource);
+    internify.set_zombie_budget(2);
+
+    const std::string *address = internify.internify("zombie-a").get();
+    EXPECT_EQ(internify.size(), 0u);
+    EXPECT_EQ(internify.memory_stats().zombie_entries, 1u);
+    EXPECT_EQ(internify.memory_stats().total_references, 0u);
+    EXPECT_FALSE(internify.find("zombie-a"));
+    EXPECT_FALSE(internify.with_interned("zombie-a", [](const std::string &)
+                                         { FAIL(); }));
+
+    // Interning it again resurrects the same node without allocating.
+    const std::size_t allocations = resource.allocations;
+    auto a = internify.internify("zombie-a");
+    EXPECT_EQ(a.get(), address);
+    EXPECT_EQ(resource.allocations, allocations);
+    EXPECT_EQ(internify.size(), 1u);
+    EXPECT_EQ(internify.memory_stats().zombie_entries, 0u);
+    const scc::SymbolId id = internify.to_id(internify.internify("zombie-a"));
+    EXPECT_EQ(internify.resolve(id), "zombie-a");
+    internify.release(id);
+
+    // Beyond the budget, older zombies are evicted.
+    a.release();
+    (void)internify.internify("zombie-b");
+    (void)internify.internify("zombie-c");
+    auto stats = internify.memory_stats();
+    EXPECT_EQ(stats.zombie_entries, 2u);
+    EXPECT_EQ(stats.live_entries, 0u);
+    std::size_t visited = 0;
+    internify.for_each([&visited](const std::string &)
+                       { ++visited; });
+    EXPECT_EQ(visited, 0u);
+
+    auto c = internify.internify("zombie-c");
+    EXPECT_EQ(internify.sweep_zombies(), 1u);
+    EXPECT_EQ(internify.size(), 1u);
+    EXPECT_EQ(*c, "zombie-c");
+
+    // Many zombies grow the table like live entries, and compact() sweeps them.
+    internify.set_zombie_budget(5000);
+    for (int i = 0; i < 5000; ++i)
+    {
+        (void)internify.internify("many-" + std::to_string(i));
+    }
+    EXPECT_EQ(internify.memory_stats().zombie_entries, 5000u);
+    for (int i = 0; i < 5000; i += 7)
+    {
+        EXPECT_EQ(*internify.internify("many-" + std::to_string(i)), "many-" + std::to_string(i));
+    }
+    internify.set_zombie_budget(100);
+    EXPECT_EQ(internify.memory_stats().zombie_entries, 100u);
+    internify.compact();
+    EXPECT_EQ(internify.memory_stats().zombie_entries, 0u);
+    EXPECT_EQ(internify.size(), 1u);
+}
+
+TEST(ShardedInternifyTest, ConcurrentZombies)
+{
+    scc::ShardedInternify<std::string, scc::Hash<std::string>, std::equal_to<>, 4> internify;
+    internify.set_zombie_budget(64);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&internify, t]
+                             {
+                                 for (int i = 0; i < 20000; ++i)
+                                 {
+                                     const std::string key = "churn-" + std::to_string((i * (t + 1)) % 100);
+                                     auto ptr = internify.internify(key);
+                                     EXPECT_EQ(*ptr, key);
+                                     auto found = internify.find(key);
+                                     EXPECT_EQ(found, ptr);
+                                     if (i % 1000 == 0)
+                                     {
+                                         internify.sweep_zombies();
+                                     }
+                                 } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(internify.size(), 0u);
+    EXPECT_LE(internify.memory_stats().zombie_entries, 64u);
+}
+
+TEST(InternifyTest, BulkIntern)
+{
+    std::vector<std::string> input;
+    for (int i = 0; i < 30000; ++i)
+    {
+        input.push_back("bulk-" + std::to_string(i % 10000));
+    }
+
+    scc::Internify<std::string> internify;
+    auto early = internify.internify("bulk-7");
+    std::vector<scc::Internify<std::string>::InternedPtr> handles(input.size());
+    internify.intern_bulk(input.begin(), input.end(), handles.begin());
+    EXPECT_EQ(internify.size(), 10000u);
+    for (std::size_t i = 0; i < input.size(); ++i)
+    {
+        EXPECT_EQ(*handles[i], input[i]);
+        EXPECT_EQ(handles[i], handles[i % 10000]);
+    }
+    EXPECT_EQ(handles[7], early);
+
+    scc::ShardedInternify<std::string> sharded;
+    std::vector<std::string_view> keys(input.begin(), input.end());
+    std::vector<scc::SymbolId> ids(keys.size());
+    sharded.intern_bulk(keys.begin(), keys.end(), ids.begin());
+    EXPECT_EQ(sharded.size(), 10000u);
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        EXPECT_EQ(sharded.resolve(ids[i]), keys[i]);
+        EXPECT_EQ(ids[i], ids[i % 10000]);
+    }
+    for (scc::SymbolId id : ids)
+    {
+        sharded.release(id);
+    }
+    EXPECT_EQ(sharded.size(), 0u);
+
+    std::vector<scc::ShardedInternify<std::string>::InternedPtr> small(3);
+    sharded.intern_bulk(input.begin(), input.begin() + 3, small.begin());
+    EXPECT_EQ(*small[2], "bulk-2");
+    EXPECT_EQ(sharded.size(), 3u);
+}
+
+TEST(ShardedInternifyTest, ConcurrentBulkIntern)
+{
+    scc::ShardedInternify<std::string> internify;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&internify, t]
+                             {
+                                 std::vector<std::string> input;
+                                 for (int i = 0; i < 20000; ++i)
+                                 {
+                                     input.push_back("shared-" + std::to_string((i * (t + 1)) % 5000));
+                                 }
+                                 std::vector<scc::ShardedInternify<std::string>::InternedPtr> handles(input.size());
+                                 internify.intern_bulk(input.begin(), input.end(), handles.begin());
+                                 for (std::size_t i = 0; i < input.size(); ++i)
+                                 {
+                                     EXPECT_EQ(*handles[i], input[i]);
+                                 } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(internify.size(), 0u);
+}